@@ -0,0 +1,74 @@
+// Arena.cpp
+#include "Arena.h"
+
+static const long CHUNK_SIZE = 65536;
+
+Arena::Arena() : head(nullptr) {}
+
+Arena::~Arena() {
+    clear();
+}
+
+void Arena::clear() {
+    while (head) {
+        Chunk* next = head->next;
+        delete[] head->data;
+        delete head;
+        head = next;
+    }
+}
+
+void Arena::reset() {
+    if (!head) return;
+    Chunk* older = head->next;
+    while (older) {
+        Chunk* next = older->next;
+        delete[] older->data;
+        delete older;
+        older = next;
+    }
+    head->next = nullptr;
+    head->used = 0;
+}
+
+void* Arena::allocate(long size, long align) {
+    if (head) {
+        long start = (head->used + align - 1) & ~(align - 1);
+        if (start + size <= head->capacity) {
+            head->used = start + size;
+            return head->data + start;
+        }
+    }
+    
+    // new[] storage is aligned for any fundamental type
+    Chunk* chunk = new Chunk;
+    chunk->capacity = size > CHUNK_SIZE ? size : CHUNK_SIZE;
+    chunk->data = new char[chunk->capacity];
+    chunk->used = size;
+    chunk->next = head;
+    head = chunk;
+    return chunk->data;
+}
+
+const char* Arena::store(const char* str, int len) {
+    char* dest = (char*)allocate(len + 1, 1);
+    for (int i = 0; i < len; i++) {
+        dest[i] = str[i];
+    }
+    dest[len] = '\0';
+    return dest;
+}
+
+void Arena::absorb(Arena& other) {
+    if (!other.head) return;
+    if (!head) {
+        head = other.head;
+    } else {
+        // Keep filling our own head; the absorbed chunks go behind it
+        Chunk* tail = other.head;
+        while (tail->next) tail = tail->next;
+        tail->next = head->next;
+        head->next = other.head;
+    }
+    other.head = nullptr;
+}
@@ -0,0 +1,48 @@
+// Arena.h
+#ifndef ARENA_H
+#define ARENA_H
+
+// Bump-pointer allocator: memory is carved out of large chunks and only
+// released all at once, so an allocation is a pointer bump and tearing
+// down everything allocated from the arena costs one free per chunk.
+//
+// A StudentDatabase owns one for the strings of its loaded students. For
+// parallel loads each thread fills its own sub-arena without locking and
+// the database absorb()s it afterwards; nothing is copied.
+class Arena {
+private:
+    struct Chunk {
+        char* data;
+        long used;
+        long capacity;
+        Chunk* next;
+    };
+    
+    Chunk* head;   // chunk currently being filled; older chunks follow it
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+public:
+    Arena();
+    ~Arena();
+    
+    // Returns size bytes aligned to align (a power of two)
+    void* allocate(long size, long align);
+    
+    // Copies len bytes of str plus a terminating NUL into the arena
+    const char* store(const char* str, int len);
+    
+    // Frees every allocation
+    void clear();
+    
+    // Invalidates every allocation but keeps the newest chunk for reuse,
+    // so an arena that is reset per batch stops allocating once warmed up
+    void reset();
+    
+    // Takes ownership of all of other's chunks; other is left empty.
+    // Allocations made from other stay valid at the same addresses.
+    void absorb(Arena& other);
+};
+
+#endif
@@ -0,0 +1,93 @@
+// BufferedWriter.cpp
+#include "BufferedWriter.h"
+
+#define SYS_WRITE 1
+#define SYS_OPEN 2
+#define SYS_CLOSE 3
+#define SYS_PWRITE64 18
+
+#define OPEN_WRITE_CREATE_TRUNC 0x241
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+extern "C" long syscall4(long number, long arg1, long arg2, long arg3, long arg4);
+
+BufferedWriter::BufferedWriter(long bufferSize)
+    : fd(-1), buffer(new char[bufferSize]), used(0), capacity(bufferSize),
+      written(0), failed(false), ownsFd(true), startOffset(-1) {}
+
+BufferedWriter::~BufferedWriter() {
+    close();
+    delete[] buffer;
+}
+
+bool BufferedWriter::open(const char* filename) {
+    close();
+    fd = syscall4(SYS_OPEN, (long)filename, OPEN_WRITE_CREATE_TRUNC, 0644, 0);
+    used = 0;
+    written = 0;
+    failed = fd < 0;
+    ownsFd = true;
+    startOffset = -1;
+    return !failed;
+}
+
+void BufferedWriter::attach(long fileFd, long offset) {
+    close();
+    fd = fileFd;
+    used = 0;
+    written = 0;
+    failed = fd < 0;
+    ownsFd = false;
+    startOffset = offset;
+}
+
+bool BufferedWriter::close() {
+    if (fd >= 0) {
+        flush();
+        if (ownsFd) syscall3(SYS_CLOSE, fd, 0, 0);
+        fd = -1;
+    }
+    return !failed;
+}
+
+void BufferedWriter::flush() {
+    long offset = 0;
+    while (offset < used && fd >= 0) {
+        long result = startOffset < 0
+            ? syscall3(SYS_WRITE, fd, (long)(buffer + offset), used - offset)
+            : syscall4(SYS_PWRITE64, fd, (long)(buffer + offset), used - offset,
+                       startOffset + written + offset);
+        if (result <= 0) {
+            failed = true;
+            break;
+        }
+        offset += result;
+    }
+    written += used;
+    used = 0;
+}
+
+void BufferedWriter::write(const void* data, long len) {
+    const char* bytes = (const char*)data;
+    while (len > 0) {
+        if (used == capacity) flush();
+        long chunk = capacity - used;
+        if (chunk > len) chunk = len;
+        for (long i = 0; i < chunk; i++) {
+            buffer[used + i] = bytes[i];
+        }
+        used += chunk;
+        bytes += chunk;
+        len -= chunk;
+    }
+}
+
+char* BufferedWriter::reserve(long len) {
+    if (capacity - used < len) flush();
+    if (capacity < len) {
+        delete[] buffer;
+        buffer = new char[len];
+        capacity = len;
+    }
+    return buffer + used;
+}
@@ -0,0 +1,47 @@
+// BufferedWriter.h
+#ifndef BUFFERED_WRITER_H
+#define BUFFERED_WRITER_H
+
+// Accumulates output in a large buffer and issues one write() per fill,
+// instead of one syscall per record.
+class BufferedWriter {
+private:
+    long fd;
+    char* buffer;
+    long used;
+    long capacity;
+    long written;      // bytes handed to the kernel so far
+    bool failed;
+    bool ownsFd;
+    long startOffset;  // file offset of byte 0 when attached, -1 otherwise
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+public:
+    explicit BufferedWriter(long bufferSize = 1 << 20);
+    ~BufferedWriter();
+
+    // Creates or truncates filename
+    bool open(const char* filename);
+    // Writes into an already open fd with pwrite(), starting at offset.
+    // Several writers can fill disjoint ranges of one file concurrently;
+    // close() flushes but leaves the fd open.
+    void attach(long fileFd, long offset);
+    // Flushes and closes; returns false if any write failed
+    bool close();
+
+    void write(const void* data, long len);
+    void flush();
+    
+    // Returns room for len bytes inside the buffer, to format into directly;
+    // commit() then records how many were actually used
+    char* reserve(long len);
+    void commit(long len) { used += len; }
+
+    // Bytes written so far, including those still buffered
+    long getOffset() const { return written + used; }
+    bool hasFailed() const { return failed; }
+};
+
+#endif
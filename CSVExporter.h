@@ -0,0 +1,269 @@
+// CSVExporter.h
+#ifndef CSV_EXPORTER_H
+#define CSV_EXPORTER_H
+
+#include "Student.h"
+#include "StringUtils.h"
+#include "BufferedWriter.h"
+#include "ThreadPool.h"
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+extern "C" long syscall4(long number, long arg1, long arg2, long arg3, long arg4);
+
+// "00".."99": decimal output is produced two digits per step
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+inline int decimalLength(unsigned long long value) {
+    int length = 1;
+    while (value >= 10) {
+        value /= 10;
+        length++;
+    }
+    return length;
+}
+
+// Writes value at out and returns the position just past it
+inline char* appendDecimal(char* out, unsigned long long value) {
+    int length = decimalLength(value);
+    char* end = out + length;
+    char* pos = end;
+    while (value >= 100) {
+        int pair = (int)(value % 100) * 2;
+        value /= 100;
+        *--pos = DIGIT_PAIRS[pair + 1];
+        *--pos = DIGIT_PAIRS[pair];
+    }
+    if (value >= 10) {
+        int pair = (int)value * 2;
+        *--pos = DIGIT_PAIRS[pair + 1];
+        *--pos = DIGIT_PAIRS[pair];
+    } else {
+        *--pos = (char)('0' + value);
+    }
+    return end;
+}
+
+// Formats a roll number / course ID as CSV text: length() is the exact
+// number of bytes append() will produce. Integral keys print in decimal.
+template<typename T>
+struct CSVExportField {
+    static unsigned long long magnitude(const T& value) {
+        return value < (T)0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    }
+    static long length(const T& value) {
+        return decimalLength(magnitude(value)) + (value < (T)0 ? 1 : 0);
+    }
+    static char* append(char* out, const T& value) {
+        if (value < (T)0) *out++ = '-';
+        return appendDecimal(out, magnitude(value));
+    }
+};
+
+// Strings are written as stored; the loader keeps field text verbatim, so
+// exported rows read back unchanged
+template<>
+struct CSVExportField<const char*> {
+    static long length(const char* value) {
+        return value ? my_strlen(value) : 0;
+    }
+    static char* append(char* out, const char* value) {
+        if (value) {
+            while (*value) *out++ = *value++;
+        }
+        return out;
+    }
+};
+
+// Writes a view (any array of student pointers: insertion order, a sorted
+// view or query results) as CSV in the format CSVReader loads:
+// Name,RollNumber,Branch,Year,CurrentCourse,Course1,Grade1,...
+class CSVExporter {
+private:
+    template<typename RollNumType, typename CourseIDType>
+    static long rowLength(const Student<RollNumType, CourseIDType>& student) {
+        long length = CSVExportField<const char*>::length(student.getName()) + 1
+                    + CSVExportField<RollNumType>::length(student.getRollNumber()) + 1
+                    + CSVExportField<const char*>::length(student.getBranch()) + 1
+                    + CSVExportField<int>::length(student.getStartingYear()) + 1
+                    + 1;   // newline
+        if (student.getCurrentCoursesCount() > 0) {
+            length += CSVExportField<CourseIDType>::length(student.getCurrentCourse(0).getCourseId());
+        }
+        for (int i = 0; i < student.getCompletedCoursesCount(); i++) {
+            const Course<CourseIDType>& course = student.getCompletedCourse(i);
+            length += 1 + CSVExportField<CourseIDType>::length(course.getCourseId())
+                    + 1 + CSVExportField<int>::length(course.getGrade());
+        }
+        return length;
+    }
+
+    template<typename RollNumType, typename CourseIDType>
+    static char* appendRow(char* out, const Student<RollNumType, CourseIDType>& student) {
+        out = CSVExportField<const char*>::append(out, student.getName());
+        *out++ = ',';
+        out = CSVExportField<RollNumType>::append(out, student.getRollNumber());
+        *out++ = ',';
+        out = CSVExportField<const char*>::append(out, student.getBranch());
+        *out++ = ',';
+        out = CSVExportField<int>::append(out, student.getStartingYear());
+        *out++ = ',';
+        if (student.getCurrentCoursesCount() > 0) {
+            out = CSVExportField<CourseIDType>::append(out, student.getCurrentCourse(0).getCourseId());
+        }
+        for (int i = 0; i < student.getCompletedCoursesCount(); i++) {
+            const Course<CourseIDType>& course = student.getCompletedCourse(i);
+            *out++ = ',';
+            out = CSVExportField<CourseIDType>::append(out, course.getCourseId());
+            *out++ = ',';
+            out = CSVExportField<int>::append(out, course.getGrade());
+        }
+        *out++ = '\n';
+        return out;
+    }
+
+    // Formats view[first..end) through writer
+    template<typename RollNumType, typename CourseIDType>
+    static void writeRows(const Student<RollNumType, CourseIDType>* const* view, int first, int end,
+                          BufferedWriter& writer) {
+        for (int i = first; i < end; i++) {
+            long length = rowLength(*view[i]);
+            char* row = writer.reserve(length);
+            appendRow(row, *view[i]);
+            writer.commit(length);
+        }
+    }
+
+    template<typename RollNumType, typename CourseIDType>
+    static void writeHeader(const Student<RollNumType, CourseIDType>* const* view, int count, BufferedWriter& writer) {
+        int maxCompleted = 0;
+        for (int i = 0; i < count; i++) {
+            if (view[i]->getCompletedCoursesCount() > maxCompleted) {
+                maxCompleted = view[i]->getCompletedCoursesCount();
+            }
+        }
+
+        const char* base = "Name,RollNumber,Branch,Year,CurrentCourse";
+        writer.write(base, my_strlen(base));
+        char column[32];
+        for (int k = 1; k <= maxCompleted; k++) {
+            char* pos = column;
+            pos = CSVExportField<const char*>::append(pos, ",Course");
+            pos = appendDecimal(pos, k);
+            pos = CSVExportField<const char*>::append(pos, ",Grade");
+            pos = appendDecimal(pos, k);
+            writer.write(column, pos - column);
+        }
+        writer.write("\n", 1);
+    }
+
+    // Per-thread slice of the view for parallel export
+    template<typename RollNumType, typename CourseIDType>
+    struct ExportChunk {
+        const Student<RollNumType, CourseIDType>* const* view;
+        int first;
+        int end;
+        long fd;
+        long offset;   // file offset of row `first`
+        long bytes;    // formatted size of the slice
+        bool failed;
+    };
+
+    template<typename RollNumType, typename CourseIDType>
+    static void* measureThread(void* arg) {
+        ExportChunk<RollNumType, CourseIDType>* chunk =
+            static_cast<ExportChunk<RollNumType, CourseIDType>*>(arg);
+        long bytes = 0;
+        for (int i = chunk->first; i < chunk->end; i++) {
+            bytes += rowLength(*chunk->view[i]);
+        }
+        chunk->bytes = bytes;
+        return nullptr;
+    }
+
+    template<typename RollNumType, typename CourseIDType>
+    static void* formatThread(void* arg) {
+        ExportChunk<RollNumType, CourseIDType>* chunk =
+            static_cast<ExportChunk<RollNumType, CourseIDType>*>(arg);
+        BufferedWriter writer(EXPORT_BUFFER_SIZE);
+        writer.attach(chunk->fd, chunk->offset);
+        writeRows(chunk->view, chunk->first, chunk->end, writer);
+        chunk->failed = !writer.close();
+        return nullptr;
+    }
+
+public:
+    static const long EXPORT_BUFFER_SIZE = 4 << 20;
+
+    // Writes count students from view to filename. With numThreads > 1 the
+    // view is split into slices: each thread sizes its slice, the slices
+    // get consecutive file offsets, and every thread then formats and
+    // pwrite()s its own slice. Output is identical for any thread count.
+    template<typename RollNumType, typename CourseIDType>
+    static bool exportView(const char* filename, const Student<RollNumType, CourseIDType>* const* view,
+                           int count, int numThreads = 1) {
+        if (count < 0) count = 0;
+        if (numThreads < 1) numThreads = 1;
+        if (numThreads > count) numThreads = count > 0 ? count : 1;
+
+        BufferedWriter writer(EXPORT_BUFFER_SIZE);
+        if (!writer.open(filename)) return false;
+        writeHeader(view, count, writer);
+
+        if (numThreads == 1) {
+            writeRows(view, 0, count, writer);
+            return writer.close();
+        }
+
+        // Rows start right after the header; slices are written through a
+        // second descriptor with pwrite()
+        writer.flush();
+        long headerBytes = writer.getOffset();
+        long fd = syscall4(2, (long)filename, 1, 0, 0);   // O_WRONLY
+        if (fd < 0) {
+            writer.close();
+            return false;
+        }
+
+        ThreadPool& pool = ThreadPool::instance();
+        ThreadPool::Future* pending = new ThreadPool::Future[numThreads];
+        ExportChunk<RollNumType, CourseIDType>* chunks =
+            new ExportChunk<RollNumType, CourseIDType>[numThreads];
+
+        for (int i = 0; i < numThreads; i++) {
+            chunks[i].view = view;
+            chunks[i].first = (int)((long)count * i / numThreads);
+            chunks[i].end = (int)((long)count * (i + 1) / numThreads);
+            chunks[i].fd = fd;
+            chunks[i].failed = false;
+            pending[i] = pool.submit(measureThread<RollNumType, CourseIDType>, &chunks[i]);
+        }
+        for (int i = 0; i < numThreads; i++) {
+            pending[i].get();
+        }
+
+        long offset = headerBytes;
+        for (int i = 0; i < numThreads; i++) {
+            chunks[i].offset = offset;
+            offset += chunks[i].bytes;
+        }
+
+        for (int i = 0; i < numThreads; i++) {
+            pending[i] = pool.submit(formatThread<RollNumType, CourseIDType>, &chunks[i]);
+        }
+        bool ok = true;
+        for (int i = 0; i < numThreads; i++) {
+            pending[i].get();
+            if (chunks[i].failed) ok = false;
+        }
+
+        delete[] chunks;
+        delete[] pending;
+        syscall3(3, fd, 0, 0);
+        return writer.close() && ok;
+    }
+};
+
+#endif
@@ -5,57 +5,157 @@
 #include "StringUtils.h"
 #include "Student.h"
 #include "StudentDatabase.h"
+#include "StudentTable.h"
+#include "MappedFile.h"
+#include "Arena.h"
+#include "CSVScanner.h"
+#include "ThreadPool.h"
 
 extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
 extern "C" long syscall4(long number, long arg1, long arg2, long arg3, long arg4);
 
-template<typename CourseIDType>
-inline bool courseIdsEqual(const CourseIDType& a, const CourseIDType& b) {
-    return a == b;
-}
+// One CSV field as a slice of the source buffer (not NUL-terminated)
+struct FieldView {
+    const char* data;
+    int length;
+};
+
+// Converts a field into a roll number / course ID type at compile time.
+// Integral keys are parsed in place with no allocation; the primary
+// template accepts any integer type and rejects empty, non-numeric or
+// out-of-range fields.
+template<typename T>
+struct CSVField {
+    template<typename Store>
+    static bool parse(const FieldView& field, Store&, T& out) {
+        const int MAX_DIGITS = 18;   // magnitude always fits in long long
+        int i = 0;
+        bool negative = false;
+        if (i < field.length && (field.data[i] == '-' || field.data[i] == '+')) {
+            negative = field.data[i] == '-';
+            i++;
+        }
+        if (i == field.length || field.length - i > MAX_DIGITS) return false;
+        
+        long long magnitude = 0;
+        for (; i < field.length; i++) {
+            char c = field.data[i];
+            if (c < '0' || c > '9') return false;
+            magnitude = magnitude * 10 + (c - '0');
+        }
+        
+        // Reject values that do not survive the round trip through T
+        long long value = negative ? -magnitude : magnitude;
+        T converted = (T)value;
+        if ((long long)converted != value || (value < 0) != (converted < (T)0)) return false;
+        out = converted;
+        return true;
+    }
+};
 
+// String keys are borrowed pointers, so they are copied into the store:
+// an Arena for unique keys, a StringInterner for repeated ones
 template<>
-inline bool courseIdsEqual<const char*>(const char* const& a, const char* const& b) {
+struct CSVField<const char*> {
+    template<typename Store>
+    static bool parse(const FieldView& field, Store& store, const char*& out) {
+        out = store.store(field.data, field.length);
+        return true;
+    }
+};
+
+// Optional user converters passed to loadFromCSV. A null converter selects
+// the built-in CSVField<T> parser.
+template<typename RollNumType, typename CourseIDType>
+struct RecordParsers {
+    RollNumType (*parseRollNum)(const char*);
+    CourseIDType (*parseCourseId)(const char*);
+};
+
+// Options for CSVReader::generateLargeCSV. Every row is a pure function of
+// (seed, row index), so output is identical for any thread count.
+struct GeneratorConfig {
+    long long numRecords;
+    int coursesPerStudent;       // completed courses per row (0..32)
+    int iitPerThousand;          // IIT (numeric roll) students per 1000 rows
+    unsigned long long seed;
+    int numThreads;              // chunks formatted at once; 0 = thread pool size
     
-    extern int my_stricmp(const char* s1, const char* s2); 
-    return my_stricmp(a, b) == 0;
-}
+    // IIT roll numbers are YY followed by an 8-digit serial, which stays
+    // within unsigned int (at most 2399999999) up to this many rows; larger
+    // files must have iitPerThousand == 0
+    static const long long MAX_IIT_RECORDS = 99999999;
+    
+    GeneratorConfig()
+        : numRecords(3000), coursesPerStudent(2), iitPerThousand(7),
+          seed(42), numThreads(0) {}
+};
 
 class CSVReader {
 private:
-    static void parseCSVLine(const char* line, char** fields, int maxFields, int& fieldCount) {
-        fieldCount = 0;
-        int lineLen = my_strlen(line);
-        int fieldStart = 0;
-        bool inQuotes = false;
-        
-        for (int i = 0; i <= lineLen && fieldCount < maxFields; i++) {
-            if (line[i] == '"') {
-                inQuotes = !inQuotes;
-            } else if ((line[i] == ',' && !inQuotes) || line[i] == '\0') {
-                int fieldEnd = i;
-                while (fieldEnd > fieldStart && my_isspace(line[fieldEnd - 1])) {
-                    fieldEnd--;
-                }
-                
-                int fieldLen = fieldEnd - fieldStart;
-                fields[fieldCount] = new char[fieldLen + 1];
-                
-                for (int j = 0; j < fieldLen; j++) {
-                    fields[fieldCount][j] = line[fieldStart + j];
-                }
-                fields[fieldCount][fieldLen] = '\0';
-                
-                fieldCount++;
-                fieldStart = i + 1;
-            }
-        }
-    }
+    // Sample data shared by the generators
+    static constexpr const char* FIRST_NAMES[50] = {
+        "Aarav", "Vivaan", "Aditya", "Vihaan", "Arjun",
+        "Sai", "Arnav", "Ayaan", "Krishna", "Ishaan",
+        "Shaurya", "Atharv", "Advik", "Pranav", "Reyansh",
+        "Aaradhya", "Diya", "Saanvi", "Ananya", "Pari",
+        "Navya", "Angel", "Ira", "Prisha", "Anaya",
+        "Ravi", "Priya", "Amit", "Sneha", "Karan",
+        "Nisha", "Rahul", "Divya", "Meera", "Rohan",
+        "Anjali", "Vikram", "Pooja", "Aryan", "Kavya",
+        "Aakash", "Simran", "Varun", "Tanvi", "Nikhil",
+        "Ritu", "Siddharth", "Neha", "Kunal", "Shruti"
+    };
+        
+    static constexpr const char* SURNAMES[60] = {
+        "Sharma", "Verma", "Gupta", "Singh", "Patel",
+        "Kumar", "Reddy", "Yadav", "Jain", "Nair",
+        "Mehta", "Desai", "Shah", "Agarwal", "Chopra",
+        "Malhotra", "Kapoor", "Bansal", "Khanna", "Bhatia",
+        "Sethi", "Arora", "Saxena", "Mishra", "Pandey",
+        "Tiwari", "Chauhan", "Rajput", "Thakur", "Rathore",
+        "Joshi", "Kulkarni", "Deshpande", "Patil", "Pawar",
+        "Jadhav", "Shinde", "More", "Kale", "Bhosale",
+        "Iyer", "Menon", "Pillai", "Das", "Roy",
+        "Ghosh", "Mukherjee", "Chatterjee", "Banerjee", "Sen",
+        "Khan", "Ali", "Ahmed", "Hussain", "Malik",
+        "Sinha", "Choudhury", "Dutta", "Bose", "Chakraborty"
+    };
+        
+    static constexpr const char* IIIT_BRANCHES[5] = {"CSE", "ECE", "CSAM", "CSD", "CSB"};
+    static constexpr const char* IIT_BRANCHES[5] = {"CS", "EE", "ME", "CE", "CH"};
+        
+    static constexpr const char* IIIT_COURSES[20] = {
+        "OOPD", "DSA", "OS", "CN", "DBMS",
+        "AI", "ML", "NLP", "CV", "SEC",
+        "TOC", "COA", "ALGO", "WEB", "MOBILE",
+        "CLOUD", "IOT", "CYBER", "GAME", "ROBOTICS"
+    };
+        
+    static constexpr const char* IIT_COURSES[20] = {
+        "101", "202", "303", "401", "523",
+        "601", "702", "815", "920", "1005",
+        "111", "222", "333", "444", "555",
+        "666", "777", "888", "999", "1111"
+    };
+    
+    static const int MAX_COMPLETED_COURSES = 32;
+    static const int MAX_FIELDS = 5 + 2 * MAX_COMPLETED_COURSES;
     
-    static void freeFields(char** fields, int count) {
-        for (int i = 0; i < count; i++) {
-            if (fields[i]) delete[] fields[i];
+    // my_atoi over a field view
+    static int parseIntField(const FieldView& field) {
+        int i = 0;
+        int sign = 1;
+        if (i < field.length && (field.data[i] == '-' || field.data[i] == '+')) {
+            if (field.data[i] == '-') sign = -1;
+            i++;
+        }
+        int result = 0;
+        while (i < field.length && field.data[i] >= '0' && field.data[i] <= '9') {
+            result = result * 10 + (field.data[i] - '0');
+            i++;
         }
+        return sign * result;
     }
 
     static void intToChar(int num, char* buffer) {
@@ -104,136 +204,534 @@ private:
         buffer[i] = '\0';
     }
 
-public:
+    // Converts one key field, through the user callback if there is one.
+    // The callback sees a NUL-terminated copy on the stack; a string result
+    // may point into that copy, so it is stored in the arena.
+    template<typename T, typename Store>
+    static bool convertField(const FieldView& field, T (*callback)(const char*),
+                             Store& store, T& out) {
+        if (!callback) return CSVField<T>::parse(field, store, out);
+        
+        const int MAX_KEY_LEN = 255;
+        char key[MAX_KEY_LEN + 1];
+        if (field.length > MAX_KEY_LEN) return false;
+        for (int i = 0; i < field.length; i++) {
+            key[i] = field.data[i];
+        }
+        key[field.length] = '\0';
+        
+        T value = callback(key);
+        return storeConverted(value, store, out);
+    }
+    
+    template<typename T, typename Store>
+    static bool storeConverted(const T& value, Store&, T& out) {
+        out = value;
+        return true;
+    }
+    
+    template<typename Store>
+    static bool storeConverted(const char* value, Store& store, const char*& out) {
+        if (!value) return false;
+        out = store.store(value, my_strlen(value));
+        return true;
+    }
+    
+    // Builds one Student from a tokenized record and adds it to sink
+    // (a StudentDatabase or a per-thread StudentBatch). Records whose roll
+    // number does not convert are skipped, as are courses whose ID does not
+    // (e.g. IIIT string codes when loading integer course IDs). Names and
+    // roll numbers go to the sink's arena; branches, course IDs and course
+    // names repeat across students and are interned. The student borrows
+    // all of them, so building it allocates no strings of its own.
+    template<typename RollNumType, typename CourseIDType, typename Sink>
+    static void addRecord(const FieldView* fields, int fieldCount, Sink& sink,
+                          const RecordParsers<RollNumType, CourseIDType>& parsers) {
+        // CSV Format: Name,RollNumber,Branch,Year,CurrentCourse,Course1,Grade1,Course2,Grade2
+        if (fieldCount < 4) return;
+        
+        Arena& arena = sink.getArena();
+        StringInterner& interner = sink.getInterner();
+        
+        RollNumType roll;
+        if (!convertField(fields[1], parsers.parseRollNum, arena, roll)) return;
+        
+        Student<RollNumType, CourseIDType> student(
+            arena.store(fields[0].data, fields[0].length),
+            roll,
+            interner.intern(fields[2].data, fields[2].length),
+            parseIntField(fields[3]),
+            BORROW_STRINGS
+        );
+        
+        CourseIDType courseId;
+        if (fieldCount > 4 && fields[4].length > 0 &&
+            convertField(fields[4], parsers.parseCourseId, interner, courseId)) {
+            student.addCurrentCourse(Course<CourseIDType>(
+                courseId, interner.intern(fields[4].data, fields[4].length), -1, BORROW_STRINGS));
+        }
+
+        for (int f = 5; f + 1 < fieldCount; f += 2) {
+            if (convertField(fields[f], parsers.parseCourseId, interner, courseId)) {
+                student.addCompletedCourse(Course<CourseIDType>(
+                    courseId, interner.intern(fields[f].data, fields[f].length),
+                    parseIntField(fields[f + 1]), BORROW_STRINGS));
+            }
+        }
+        
+        sink.addStudent(std::move(student));
+    }
+    
+    // Returns the offset just past the first newline at or after pos that
+    // is not inside a quoted field, or size if there is none
+    static long findRecordEnd(const char* data, long pos, long size, bool inQuotes) {
+        StructuralScanner scanner(data, pos, size, inQuotes, false);
+        long newline = scanner.next();
+        return newline < size ? newline + 1 : size;
+    }
+    
+    // Parses every record in [begin, end), which must start at a record
+    // boundary. Newlines inside quoted fields do not end a record. One
+    // structural scan over the range yields both the field separators and
+    // the record ends; fields are views into data with trailing whitespace
+    // trimmed, so nothing is copied. Bytes up to readable may be loaded by
+    // the scanner. With completeOnly, a last record that has no newline is
+    // left unparsed. Returns the offset just past the last parsed record.
+    template<typename RollNumType, typename CourseIDType, typename Sink>
+    static long parseRange(const char* data, long begin, long end, long readable, Sink& sink,
+                           const RecordParsers<RollNumType, CourseIDType>& parsers,
+                           bool completeOnly = false) {
+        FieldView fields[MAX_FIELDS];
+        int fieldCount = 0;
+        StructuralScanner scanner(data, begin, end, readable, false, true);
+        
+        long recordStart = begin;
+        long fieldStart = begin;
+        while (recordStart < end) {
+            long separator = scanner.next();
+            if (separator >= end && completeOnly) break;
+            
+            if (fieldCount < MAX_FIELDS) {
+                long fieldEnd = separator;
+                while (fieldEnd > fieldStart && my_isspace(data[fieldEnd - 1])) {
+                    fieldEnd--;
+                }
+                fields[fieldCount].data = data + fieldStart;
+                fields[fieldCount].length = (int)(fieldEnd - fieldStart);
+                fieldCount++;
+            }
+            fieldStart = separator + 1;
+            
+            if (separator >= end || data[separator] == '\n') {
+                if (separator > recordStart) addRecord(fields, fieldCount, sink, parsers);
+                fieldCount = 0;
+                recordStart = separator < end ? separator + 1 : end;
+            }
+        }
+        return recordStart;
+    }
+    
+    // Offset of the first data record (the header line is skipped)
+    static long skipHeader(const char* data, long size) {
+        long pos = 0;
+        // Leading blank lines do not count as the header
+        while (pos < size && data[pos] == '\n') pos++;
+        return findRecordEnd(data, pos, size, false);
+    }
+    
+    // Per-thread work item for parallel parsing
     template<typename RollNumType, typename CourseIDType>
-    static bool loadFromCSV(const char* filename, 
-                           StudentDatabase<RollNumType, CourseIDType>& db,
-                           RollNumType (*parseRollNum)(const char*),
-                           CourseIDType (*parseCourseId)(const char*)) {
-        (void)parseRollNum;
-        (void)parseCourseId;
+    struct ParseChunk {
+        const char* data;
+        long begin;
+        long end;
+        long size;
+        long quoteCount;
+        StudentBatch<RollNumType, CourseIDType>* batch;
+        const RecordParsers<RollNumType, CourseIDType>* parsers;
+    };
+    
+    template<typename RollNumType, typename CourseIDType>
+    static void* countQuotesThread(void* arg) {
+        ParseChunk<RollNumType, CourseIDType>* chunk = 
+            static_cast<ParseChunk<RollNumType, CourseIDType>*>(arg);
+        chunk->quoteCount = countQuotes(chunk->data, chunk->begin, chunk->end);
+        return nullptr;
+    }
+    
+    template<typename RollNumType, typename CourseIDType>
+    static void* parseChunkThread(void* arg) {
+        ParseChunk<RollNumType, CourseIDType>* chunk = 
+            static_cast<ParseChunk<RollNumType, CourseIDType>*>(arg);
+        parseRange(chunk->data, chunk->begin, chunk->end, chunk->size, *chunk->batch, *chunk->parsers);
+        return nullptr;
+    }
+    
+    // Splits [data, data + size) into numThreads record-aligned ranges,
+    // parses each as a task on the shared thread pool, then splices the batches in file order
+    // so insertion order matches the serial loader. Target is a
+    // StudentDatabase or a StudentTable.
+    template<typename RollNumType, typename CourseIDType, typename Target>
+    static void parseBufferParallel(const char* data, long size, Target& db,
+                                    const RecordParsers<RollNumType, CourseIDType>& parsers,
+                                    int numThreads) {
+        const long MIN_CHUNK_BYTES = 65536;
+        long first = skipHeader(data, size);
+        long body = size - first;
+        
+        if (numThreads > body / MIN_CHUNK_BYTES) numThreads = (int)(body / MIN_CHUNK_BYTES);
+        if (numThreads <= 1) {
+            parseRange(data, first, size, size, db, parsers);
+            return;
+        }
+        
+        ThreadPool& pool = ThreadPool::instance();
+        ThreadPool::Future* pending = new ThreadPool::Future[numThreads];
+        ParseChunk<RollNumType, CourseIDType>* chunks = 
+            new ParseChunk<RollNumType, CourseIDType>[numThreads];
+        StudentBatch<RollNumType, CourseIDType>* batches = 
+            new StudentBatch<RollNumType, CourseIDType>[numThreads];
+        
+        // Pass 1: count quotes in equal byte ranges so each split point's
+        // quote state is known without a serial scan of the whole file
+        for (int i = 0; i < numThreads; i++) {
+            chunks[i].data = data;
+            chunks[i].begin = first + body * i / numThreads;
+            chunks[i].end = first + body * (i + 1) / numThreads;
+            chunks[i].size = size;
+            chunks[i].quoteCount = 0;
+            chunks[i].batch = &batches[i];
+            chunks[i].parsers = &parsers;
+            batches[i].getInterner().share(db.getInterner());
+            pending[i] = pool.submit(countQuotesThread<RollNumType, CourseIDType>, &chunks[i]);
+        }
+        for (int i = 0; i < numThreads; i++) {
+            pending[i].get();
+        }
+        
+        // Resync each split point forward to the next unquoted newline
+        long quotesBefore = chunks[0].quoteCount;
+        for (int i = 1; i < numThreads; i++) {
+            bool inQuotes = (quotesBefore % 2) != 0;
+            quotesBefore += chunks[i].quoteCount;
+            chunks[i].begin = findRecordEnd(data, chunks[i].begin, size, inQuotes);
+            chunks[i - 1].end = chunks[i].begin;
+        }
+        chunks[numThreads - 1].end = size;
+        
+        // Pass 2: parse each range into its own batch
+        for (int i = 0; i < numThreads; i++) {
+            pending[i] = pool.submit(parseChunkThread<RollNumType, CourseIDType>, &chunks[i]);
+        }
+        for (int i = 0; i < numThreads; i++) {
+            pending[i].get();
+        }
+        
+        int total = 0;
+        for (int i = 0; i < numThreads; i++) {
+            total += batches[i].getCount();
+        }
+        db.reserve(db.getCount() + total);
+        for (int i = 0; i < numThreads; i++) {
+            db.appendBatch(batches[i]);
+        }
+        
+        delete[] batches;
+        delete[] chunks;
+        delete[] pending;
+    }
+    
+    // Fallback for files that cannot be mapped: read() into a buffer that
+    // grows geometrically. Caller frees the returned buffer.
+    static char* readWholeFile(const char* filename, long& totalSize) {
+        totalSize = 0;
+        long fd = syscall3(2, (long)filename, 0, 0);
+        if (fd < 0) return nullptr;
+        
+        long capacity = 65536;
+        char* content = new char[capacity];
+        
+        long bytesRead;
+        while ((bytesRead = syscall3(0, fd, (long)(content + totalSize), capacity - totalSize)) > 0) {
+            totalSize += bytesRead;
+            if (totalSize == capacity) {
+                char* grown = new char[capacity * 2];
+                for (long i = 0; i < totalSize; i++) {
+                    grown[i] = content[i];
+                }
+                delete[] content;
+                content = grown;
+                capacity *= 2;
+            }
+        }
+        
+        syscall3(3, fd, 0, 0);
+        return content;
+    }
 
+    // Maps the file (falling back to read() when it cannot be mapped,
+    // e.g. a pipe) and parses it on numThreads threads
+    template<typename RollNumType, typename CourseIDType, typename Target>
+    static bool loadFile(const char* filename, Target& db,
+                         const RecordParsers<RollNumType, CourseIDType>& parsers,
+                         int numThreads) {
+        MappedFile file;
+        if (file.open(filename)) {
+            parseBufferParallel(file.getData(), file.getSize(), db, parsers, numThreads);
+            return true;
+        }
+        
+        long totalSize = 0;
+        char* fileContent = readWholeFile(filename, totalSize);
+        if (fileContent == nullptr) return false;
+        if (totalSize == 0) {
+            delete[] fileContent;
+            return false;
+        }
+        
+        parseBufferParallel(fileContent, totalSize, db, parsers, numThreads);
+        
+        delete[] fileContent;
+        return true;
+    }
+    
+    static const long MAX_STREAM_WINDOW = 1L << 30;
+    
+    // Sink that hands each parsed record to a visitor instead of storing it.
+    // Arena and interned strings only live until the end of the current window.
+    template<typename RollNumType, typename CourseIDType, typename Visitor>
+    struct VisitorSink {
+        Visitor& visitor;
+        Arena arena;
+        StringInterner interner;
+        bool stopped;
+        
+        VisitorSink(Visitor& v) : visitor(v), stopped(false) {}
+        
+        // Records after the visitor asks to stop are dropped
+        void addStudent(const Student<RollNumType, CourseIDType>& student) {
+            if (!stopped && !visitor(student)) stopped = true;
+        }
+        
+        Arena& getArena() { return arena; }
+        StringInterner& getInterner() { return interner; }
+    };
+    
+    // read()s the file through one window of windowSize bytes. Complete
+    // records in the window are parsed and visited; a record cut off by the
+    // window edge moves to the front and is finished by the next read. The
+    // window only grows when a single record does not fit in it.
+    template<typename RollNumType, typename CourseIDType, typename Visitor>
+    static bool streamFile(const char* filename, Visitor& visitor,
+                           const RecordParsers<RollNumType, CourseIDType>& parsers,
+                           long windowSize) {
         long fd = syscall3(2, (long)filename, 0, 0);
         if (fd < 0) return false;
         
-        const int BUFFER_SIZE = 65536;
-        char* buffer = new char[BUFFER_SIZE];
-        char* fileContent = new char[1];
-        fileContent[0] = '\0';
-        int totalSize = 0;
+        if (windowSize < 4096) windowSize = 4096;
+        if (windowSize > MAX_STREAM_WINDOW) windowSize = MAX_STREAM_WINDOW;
+        char* window = new char[windowSize];
+        long filled = 0;
+        bool atEnd = false;
+        bool headerPending = true;
+        bool ok = true;
         
-        long bytesRead;
-        while ((bytesRead = syscall3(0, fd, (long)buffer, BUFFER_SIZE - 1)) > 0) {
-            buffer[bytesRead] = '\0';
+        VisitorSink<RollNumType, CourseIDType, Visitor> sink(visitor);
+        
+        while (!atEnd && !sink.stopped) {
+            long bytesRead = syscall3(0, fd, (long)(window + filled), windowSize - filled);
+            if (bytesRead < 0) {
+                ok = false;   // read error (EIO, EISDIR, ...), not end of file
+                break;
+            }
+            if (bytesRead == 0) {
+                atEnd = true;
+            } else {
+                filled += bytesRead;
+            }
             
-            char* newContent = new char[totalSize + bytesRead + 1];
-            if (totalSize > 0) {
-                for (int i = 0; i < totalSize; i++) {
-                    newContent[i] = fileContent[i];
+            long pos = 0;
+            if (headerPending) {
+                // Leading blank lines do not count as the header
+                while (pos < filled && window[pos] == '\n') pos++;
+                long next = findRecordEnd(window, pos, filled, false);
+                if (next > pos && (window[next - 1] == '\n' || atEnd)) {
+                    headerPending = false;
+                    pos = next;
                 }
             }
-            for (int i = 0; i < bytesRead; i++) {
-                newContent[totalSize + i] = buffer[i];
+            if (!headerPending) {
+                pos = parseRange(window, pos, filled, filled, sink, parsers, !atEnd);
             }
-            newContent[totalSize + bytesRead] = '\0';
+            if (pos > filled) pos = filled;
+            sink.arena.reset();
+            sink.interner.clear();
             
-            delete[] fileContent;
-            fileContent = newContent;
-            totalSize += bytesRead;
+            // Carry the unfinished record to the front of the window
+            for (long i = pos; i < filled; i++) {
+                window[i - pos] = window[i];
+            }
+            filled -= pos;
+            
+            if (filled == windowSize) {
+                if (windowSize == MAX_STREAM_WINDOW) {
+                    ok = false;   // a single record larger than 1GB
+                    break;
+                }
+                long grownSize = windowSize * 2;
+                if (grownSize > MAX_STREAM_WINDOW) grownSize = MAX_STREAM_WINDOW;
+                char* grown = new char[grownSize];
+                for (long i = 0; i < filled; i++) {
+                    grown[i] = window[i];
+                }
+                delete[] window;
+                window = grown;
+                windowSize = grownSize;
+            }
         }
         
+        delete[] window;
         syscall3(3, fd, 0, 0);
-        delete[] buffer;
-        
-        if (totalSize == 0 || fileContent == nullptr) {
-             return false;
-        }
-        
-        int lineStart = 0;
-        bool firstLine = true;
-        
-        for (int i = 0; i <= totalSize; i++) {
-            if (fileContent[i] == '\n' || fileContent[i] == '\0') {
-                if (i > lineStart) {
-                    int lineLen = i - lineStart;
-                    char* line = new char[lineLen + 1];
-                    for (int j = 0; j < lineLen; j++) {
-                        line[j] = fileContent[lineStart + j];
-                    }
-                    line[lineLen] = '\0';
-                    
-                    if (firstLine) {
-                        firstLine = false;
-                    } else {
-                        const int MAX_FIELDS = 20;
-                        char* fields[MAX_FIELDS];
-                        int fieldCount;
-                        
-                        parseCSVLine(line, fields, MAX_FIELDS, fieldCount);
-                        
-                        // CSV Format: Name,RollNumber,Branch,Year,CurrentCourse,Course1,Grade1,Course2,Grade2
-                        if (fieldCount >= 4) {
-                            char* nameCopy = new char[my_strlen(fields[0]) + 1];
-                            my_strcpy(nameCopy, fields[0]);
-                            
-                            char* rollCopy = new char[my_strlen(fields[1]) + 1];
-                            my_strcpy(rollCopy, fields[1]);
-                            
-                            char* branchCopy = new char[my_strlen(fields[2]) + 1];
-                            my_strcpy(branchCopy, fields[2]);
-                            
-                            int year = my_atoi(fields[3]);
-                            
-                            Student<RollNumType, CourseIDType> student(
-                                nameCopy, rollCopy, branchCopy, year
-                            );
-                            
-                            if (fieldCount > 4 && my_strlen(fields[4]) > 0) {
-                                char* courseIdCopy = new char[my_strlen(fields[4]) + 1];
-                                my_strcpy(courseIdCopy, fields[4]);
-                                
-                                char* courseNameCopy = new char[my_strlen(fields[4]) + 1];
-                                my_strcpy(courseNameCopy, fields[4]);
-                                
-                                student.addCurrentCourse(Course<CourseIDType>(courseIdCopy, courseNameCopy, -1));
-                            }
+        return ok;
+    }
 
-                            if (fieldCount > 5) {
-                                for (int f = 5; f < fieldCount; f += 2) {
-                                    if (f + 1 < fieldCount) {
-                                        char* completedIdCopy = new char[my_strlen(fields[f]) + 1];
-                                        my_strcpy(completedIdCopy, fields[f]);
-                                        
-                                        char* completedNameCopy = new char[my_strlen(fields[f]) + 1];
-                                        my_strcpy(completedNameCopy, fields[f]);
-                                        
-                                        int grade = my_atoi(fields[f + 1]);
-                                        student.addCompletedCourse(Course<CourseIDType>(completedIdCopy, completedNameCopy, grade));
-                                    }
-                                }
-                            }
-                            
-                            db.addStudent(student);
-                            
-                            delete[] nameCopy;
-                            // **FIX HERE: DO NOT delete rollCopy. Student object must own this memory.**
-                            // delete[] rollCopy; 
-                            delete[] branchCopy;
-                        }
-                        
-                        freeFields(fields, fieldCount);
-                    }
-                    
-                    delete[] line;
-                }
-                lineStart = i + 1;
-                
-                if (fileContent[i] == '\0') break;
-            }
+public:
+    // Parses straight out of the page cache. Roll numbers and course IDs
+    // are converted by CSVField<T>: arena strings for const char*,
+    // in-place integer parsing for integral types.
+    template<typename RollNumType, typename CourseIDType>
+    static bool loadFromCSV(const char* filename, 
+                           StudentDatabase<RollNumType, CourseIDType>& db) {
+        RecordParsers<RollNumType, CourseIDType> parsers = { nullptr, nullptr };
+        return loadFile(filename, db, parsers, 1);
+    }
+    
+    // As above, but keys go through the given converters (either may be null)
+    template<typename RollNumType, typename CourseIDType>
+    static bool loadFromCSV(const char* filename, 
+                           StudentDatabase<RollNumType, CourseIDType>& db,
+                           RollNumType (*parseRollNum)(const char*),
+                           CourseIDType (*parseCourseId)(const char*)) {
+        RecordParsers<RollNumType, CourseIDType> parsers = { parseRollNum, parseCourseId };
+        return loadFile(filename, db, parsers, 1);
+    }
+    
+    // Same result as loadFromCSV, but the mapped file is split into
+    // numThreads record-aligned ranges that are parsed concurrently.
+    template<typename RollNumType, typename CourseIDType>
+    static bool loadFromCSVParallel(const char* filename, 
+                                    StudentDatabase<RollNumType, CourseIDType>& db,
+                                    int numThreads) {
+        RecordParsers<RollNumType, CourseIDType> parsers = { nullptr, nullptr };
+        return loadFile(filename, db, parsers, numThreads);
+    }
+    
+    template<typename RollNumType, typename CourseIDType>
+    static bool loadFromCSVParallel(const char* filename, 
+                                    StudentDatabase<RollNumType, CourseIDType>& db,
+                                    RollNumType (*parseRollNum)(const char*),
+                                    CourseIDType (*parseCourseId)(const char*),
+                                    int numThreads) {
+        RecordParsers<RollNumType, CourseIDType> parsers = { parseRollNum, parseCourseId };
+        return loadFile(filename, db, parsers, numThreads);
+    }
+    
+    // Loads into the columnar StudentTable instead of Student records
+    template<typename RollNumType, typename CourseIDType>
+    static bool loadFromCSV(const char* filename, 
+                           StudentTable<RollNumType, CourseIDType>& table) {
+        RecordParsers<RollNumType, CourseIDType> parsers = { nullptr, nullptr };
+        return loadFile(filename, table, parsers, 1);
+    }
+    
+    template<typename RollNumType, typename CourseIDType>
+    static bool loadFromCSVParallel(const char* filename, 
+                                    StudentTable<RollNumType, CourseIDType>& table,
+                                    int numThreads) {
+        RecordParsers<RollNumType, CourseIDType> parsers = { nullptr, nullptr };
+        return loadFile(filename, table, parsers, numThreads);
+    }
+    
+    // Tail-follow step: parses the complete records appended to the file
+    // since offset and adds them with db.appendIncremental, so prepared
+    // views and the grade index are updated rather than rebuilt. offset
+    // advances past the consumed records; a trailing partial line is left
+    // for the next call. offset 0 means nothing was read yet, so the header
+    // is skipped. Returns the number of students added, or -1 if the file
+    // cannot be read or has shrunk below offset (rewritten, not appended).
+    template<typename RollNumType, typename CourseIDType>
+    static int appendFromCSV(const char* filename,
+                             StudentDatabase<RollNumType, CourseIDType>& db,
+                             long& offset) {
+        long fd = syscall3(2, (long)filename, 0, 0);
+        if (fd < 0) return -1;
+        
+        long size = syscall3(8, fd, 0, 2);
+        if (size < offset) {
+            syscall3(3, fd, 0, 0);
+            return -1;
         }
         
-        delete[] fileContent;
-        return true;
+        long pending = size - offset;
+        char* buffer = new char[pending > 0 ? pending : 1];
+        long got = 0;
+        while (got < pending) {
+            long bytesRead = syscall4(17, fd, (long)(buffer + got), pending - got, offset + got);
+            if (bytesRead <= 0) break;
+            got += bytesRead;
+        }
+        syscall3(3, fd, 0, 0);
+        
+        long begin = 0;
+        if (offset == 0) {
+            begin = skipHeader(buffer, got);
+            if (begin == got && (got == 0 || buffer[got - 1] != '\n')) begin = 0;
+        }
+        StudentBatch<RollNumType, CourseIDType> batch;
+        batch.getInterner().share(db.getInterner());
+        RecordParsers<RollNumType, CourseIDType> parsers = { nullptr, nullptr };
+        // Only records terminated by a newline are complete
+        long consumed = parseRange(buffer, begin, got, got, batch, parsers, true);
+        delete[] buffer;
+        
+        offset += consumed;
+        return db.appendIncremental(batch);
+    }
+    
+    // Number of bytes in the file, or -1 if it cannot be opened
+    static long fileSize(const char* filename) {
+        long fd = syscall3(2, (long)filename, 0, 0);
+        if (fd < 0) return -1;
+        long size = syscall3(8, fd, 0, 2);
+        syscall3(3, fd, 0, 0);
+        return size;
+    }
+    
+    // Default window for streamCSV
+    static const long STREAM_WINDOW_SIZE = 1 << 20;
+    
+    // Streams the file through a fixed-size window and calls
+    // visitor(const Student<RollNumType, CourseIDType>&) for every record,
+    // in file order, without keeping any of them. The student and its
+    // strings are only valid during the call. Returning false from the
+    // visitor stops the scan. Peak memory is the window plus one record,
+    // whatever the file size. Returns false if the file cannot be opened
+    // or a read fails part way, so a truncated scan is not mistaken for
+    // the end of the file.
+    template<typename RollNumType, typename CourseIDType, typename Visitor>
+    static bool streamCSV(const char* filename, Visitor&& visitor,
+                          long windowSize = STREAM_WINDOW_SIZE) {
+        RecordParsers<RollNumType, CourseIDType> parsers = { nullptr, nullptr };
+        return streamFile(filename, visitor, parsers, windowSize);
+    }
+    
+    template<typename RollNumType, typename CourseIDType, typename Visitor>
+    static bool streamCSV(const char* filename, Visitor&& visitor,
+                          RollNumType (*parseRollNum)(const char*),
+                          CourseIDType (*parseCourseId)(const char*),
+                          long windowSize = STREAM_WINDOW_SIZE) {
+        RecordParsers<RollNumType, CourseIDType> parsers = { parseRollNum, parseCourseId };
+        return streamFile(filename, visitor, parsers, windowSize);
     }
     
     // COMPLETELY REWRITTEN - Building string step by step with clear field markers
@@ -245,50 +743,12 @@ public:
         const char* header = "Name,RollNumber,Branch,Year,CurrentCourse,Course1,Grade1,Course2,Grade2\n";
         syscall3(1, fd, (long)header, my_strlen(header));
         
-        const char* names[] = {
-            "Aarav", "Vivaan", "Aditya", "Vihaan", "Arjun",
-            "Sai", "Arnav", "Ayaan", "Krishna", "Ishaan",
-            "Shaurya", "Atharv", "Advik", "Pranav", "Reyansh",
-            "Aaradhya", "Diya", "Saanvi", "Ananya", "Pari",
-            "Navya", "Angel", "Ira", "Prisha", "Anaya",
-            "Ravi", "Priya", "Amit", "Sneha", "Karan",
-            "Nisha", "Rahul", "Divya", "Meera", "Rohan",
-            "Anjali", "Vikram", "Pooja", "Aryan", "Kavya",
-            "Aakash", "Simran", "Varun", "Tanvi", "Nikhil",
-            "Ritu", "Siddharth", "Neha", "Kunal", "Shruti"
-        };
-        
-        const char* surnames[] = {
-            "Sharma", "Verma", "Gupta", "Singh", "Patel",
-            "Kumar", "Reddy", "Yadav", "Jain", "Nair",
-            "Mehta", "Desai", "Shah", "Agarwal", "Chopra",
-            "Malhotra", "Kapoor", "Bansal", "Khanna", "Bhatia",
-            "Sethi", "Arora", "Saxena", "Mishra", "Pandey",
-            "Tiwari", "Chauhan", "Rajput", "Thakur", "Rathore",
-            "Joshi", "Kulkarni", "Deshpande", "Patil", "Pawar",
-            "Jadhav", "Shinde", "More", "Kale", "Bhosale",
-            "Iyer", "Menon", "Pillai", "Das", "Roy",
-            "Ghosh", "Mukherjee", "Chatterjee", "Banerjee", "Sen",
-            "Khan", "Ali", "Ahmed", "Hussain", "Malik",
-            "Sinha", "Choudhury", "Dutta", "Bose", "Chakraborty"
-        };
-        
-        const char* branches[] = {"CSE", "ECE", "CSAM", "CSD", "CSB"};
-        const char* iitBranches[] = {"CS", "EE", "ME", "CE", "CH"};
-        
-        const char* iiitCourses[] = {
-            "OOPD", "DSA", "OS", "CN", "DBMS",
-            "AI", "ML", "NLP", "CV", "SEC",
-            "TOC", "COA", "ALGO", "WEB", "MOBILE",
-            "CLOUD", "IOT", "CYBER", "GAME", "ROBOTICS"
-        };
-        
-        const char* iitCourses[] = {
-            "101", "202", "303", "401", "523",
-            "601", "702", "815", "920", "1005",
-            "111", "222", "333", "444", "555",
-            "666", "777", "888", "999", "1111"
-        };
+        const char* const* names = FIRST_NAMES;
+        const char* const* surnames = SURNAMES;
+        const char* const* branches = IIIT_BRANCHES;
+        const char* const* iitBranches = IIT_BRANCHES;
+        const char* const* iiitCourses = IIIT_COURSES;
+        const char* const* iitCourses = IIT_COURSES;
         
         int iitCounter = 0;
         char lineBuffer[512];
@@ -445,6 +905,200 @@ public:
         
         syscall3(3, fd, 0, 0);
     }
+private:
+    static void appendText(char* buffer, int& pos, const char* text) {
+        while (*text) buffer[pos++] = *text++;
+    }
+    
+    // Decimal digits of value, zero-padded to at least minDigits
+    static void appendNumber(char* buffer, int& pos, unsigned long long value, int minDigits) {
+        char digits[24];
+        int count = 0;
+        do {
+            digits[count++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (count < minDigits) digits[count++] = '0';
+        while (count > 0) buffer[pos++] = digits[--count];
+    }
+    
+    // splitmix64 finalizer: a well-mixed 64-bit value per input
+    static unsigned long long mixBits(unsigned long long x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+    
+    // Longest row generateLargeCSV can produce
+    static const int MAX_GENERATED_ROW = 1024;
+    
+    // Rows formatted per chunk; a round formats one chunk per worker
+    static const long long GENERATOR_CHUNK_ROWS = 16384;
+    
+    // Formats generated row `row` into buffer; returns its length including
+    // the newline. Roll numbers embed row + 1 as the serial, so they are
+    // unique: YY<8-digit serial> for IIT, MT/PhD YY<serial> for IIIT.
+    static int formatGeneratedRow(const GeneratorConfig& config, long long row, char* buffer) {
+        unsigned long long state = mixBits(config.seed ^ mixBits((unsigned long long)row));
+        int pos = 0;
+        
+        appendText(buffer, pos, FIRST_NAMES[state % 50]);
+        buffer[pos++] = ' ';
+        appendText(buffer, pos, SURNAMES[(state >> 8) % 60]);
+        buffer[pos++] = ',';
+        
+        state = mixBits(state);
+        bool isIITStudent = (int)(state % 1000) < config.iitPerThousand;
+        int year = 2020 + (int)((state >> 16) % 4);
+        int yearSuffix = year - 2000;
+        
+        if (!isIITStudent) {
+            appendText(buffer, pos, ((state >> 24) % 3 == 0) ? "PhD" : "MT");
+        }
+        appendNumber(buffer, pos, yearSuffix, 2);
+        appendNumber(buffer, pos, (unsigned long long)row + 1, isIITStudent ? 8 : 3);
+        buffer[pos++] = ',';
+        
+        appendText(buffer, pos, isIITStudent ? IIT_BRANCHES[(state >> 32) % 5] : IIIT_BRANCHES[(state >> 32) % 5]);
+        buffer[pos++] = ',';
+        appendNumber(buffer, pos, year, 1);
+        buffer[pos++] = ',';
+        
+        state = mixBits(state);
+        appendText(buffer, pos, (state & 1) ? IIT_COURSES[(state >> 8) % 20] : IIIT_COURSES[(state >> 8) % 20]);
+        
+        for (int c = 0; c < config.coursesPerStudent; c++) {
+            state = mixBits(state);
+            buffer[pos++] = ',';
+            appendText(buffer, pos, (state & 1) ? IIT_COURSES[(state >> 8) % 20] : IIIT_COURSES[(state >> 8) % 20]);
+            buffer[pos++] = ',';
+            appendNumber(buffer, pos, 6 + (state >> 32) % 5, 1);
+        }
+        
+        buffer[pos++] = '\n';
+        return pos;
+    }
+    
+    // One chunk of a generated file, formatted once into its own buffer
+    struct GeneratorChunk {
+        const GeneratorConfig* config;
+        long long firstRow;
+        long long endRow;
+        char* buffer;       // GENERATOR_CHUNK_ROWS * MAX_GENERATED_ROW bytes
+        long long bytes;    // formatted length
+        long long offset;   // file offset of firstRow
+        long fd;
+        bool failed;
+    };
+    
+    static void* formatRowsThread(void* arg) {
+        GeneratorChunk* chunk = static_cast<GeneratorChunk*>(arg);
+        long long used = 0;
+        for (long long r = chunk->firstRow; r < chunk->endRow; r++) {
+            used += formatGeneratedRow(*chunk->config, r, chunk->buffer + used);
+        }
+        chunk->bytes = used;
+        return nullptr;
+    }
+    
+    static bool pwriteAll(long fd, const char* data, long long len, long long offset) {
+        while (len > 0) {
+            long written = syscall4(18, fd, (long)data, (long)len, (long)offset);
+            if (written <= 0) return false;
+            data += written;
+            len -= written;
+            offset += written;
+        }
+        return true;
+    }
+    
+    static void* writeRowsThread(void* arg) {
+        GeneratorChunk* chunk = static_cast<GeneratorChunk*>(arg);
+        chunk->failed = !pwriteAll(chunk->fd, chunk->buffer, chunk->bytes, chunk->offset);
+        return nullptr;
+    }
+
+public:
+    // Generates config.numRecords rows on the shared thread pool. Rows are
+    // produced in rounds of config.numThreads chunks (0 means one per pool
+    // worker): each chunk is formatted once into its own buffer, an
+    // exclusive prefix sum of the chunk lengths gives every chunk its file
+    // offset, and the chunks are then pwrite()n in place. Fails without
+    // writing if IIT roll numbers would not fit in unsigned int.
+    static bool generateLargeCSV(const char* filename, const GeneratorConfig& config) {
+        GeneratorConfig cfg = config;
+        if (cfg.coursesPerStudent < 0) cfg.coursesPerStudent = 0;
+        if (cfg.coursesPerStudent > MAX_COMPLETED_COURSES) cfg.coursesPerStudent = MAX_COMPLETED_COURSES;
+        if (cfg.numRecords < 0) cfg.numRecords = 0;
+        if (cfg.iitPerThousand > 0 && cfg.numRecords > GeneratorConfig::MAX_IIT_RECORDS) return false;
+        int numThreads = cfg.numThreads < 1 ? ThreadPool::instance().getSize() : cfg.numThreads;
+        long long chunkCount = (cfg.numRecords + GENERATOR_CHUNK_ROWS - 1) / GENERATOR_CHUNK_ROWS;
+        if (numThreads > chunkCount) numThreads = chunkCount > 0 ? (int)chunkCount : 1;
+        
+        long fd = syscall4(2, (long)filename, 0x241, 0644, 0);
+        if (fd < 0) return false;
+        
+        char header[MAX_GENERATED_ROW * 2];
+        int headerLen = 0;
+        appendText(header, headerLen, "Name,RollNumber,Branch,Year,CurrentCourse");
+        for (int c = 1; c <= cfg.coursesPerStudent; c++) {
+            appendText(header, headerLen, ",Course");
+            appendNumber(header, headerLen, c, 1);
+            appendText(header, headerLen, ",Grade");
+            appendNumber(header, headerLen, c, 1);
+        }
+        header[headerLen++] = '\n';
+        bool ok = pwriteAll(fd, header, headerLen, 0);
+        
+        ThreadPool& pool = ThreadPool::instance();
+        ThreadPool::Future* pending = new ThreadPool::Future[numThreads];
+        GeneratorChunk* chunks = new GeneratorChunk[numThreads];
+        for (int i = 0; i < numThreads; i++) {
+            chunks[i].config = &cfg;
+            chunks[i].buffer = new char[GENERATOR_CHUNK_ROWS * MAX_GENERATED_ROW];
+            chunks[i].fd = fd;
+            chunks[i].failed = false;
+        }
+        
+        long long offset = headerLen;
+        long long nextRow = 0;
+        while (ok && nextRow < cfg.numRecords) {
+            int active = 0;
+            for (; active < numThreads && nextRow < cfg.numRecords; active++) {
+                chunks[active].firstRow = nextRow;
+                nextRow += GENERATOR_CHUNK_ROWS;
+                if (nextRow > cfg.numRecords) nextRow = cfg.numRecords;
+                chunks[active].endRow = nextRow;
+                pending[active] = pool.submit(formatRowsThread, &chunks[active]);
+            }
+            for (int i = 0; i < active; i++) {
+                pending[i].get();
+            }
+            
+            // Exclusive prefix sum: each chunk starts where the previous ends
+            for (int i = 0; i < active; i++) {
+                chunks[i].offset = offset;
+                offset += chunks[i].bytes;
+            }
+            
+            for (int i = 0; i < active; i++) {
+                pending[i] = pool.submit(writeRowsThread, &chunks[i]);
+            }
+            for (int i = 0; i < active; i++) {
+                pending[i].get();
+                if (chunks[i].failed) ok = false;
+            }
+        }
+        
+        for (int i = 0; i < numThreads; i++) {
+            delete[] chunks[i].buffer;
+        }
+        delete[] pending;
+        delete[] chunks;
+        syscall3(3, fd, 0, 0);
+        return ok;
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+// CSVScanner.cpp
+#include "CSVScanner.h"
+#include <immintrin.h>
+
+static void scanBlockScalar(const char* block, StructuralMasks& masks) {
+    masks.quotes = 0;
+    masks.commas = 0;
+    masks.newlines = 0;
+    for (int i = 0; i < SCAN_BLOCK_SIZE; i++) {
+        unsigned long long bit = 1ULL << i;
+        if (block[i] == '"') masks.quotes |= bit;
+        else if (block[i] == ',') masks.commas |= bit;
+        else if (block[i] == '\n') masks.newlines |= bit;
+    }
+}
+
+static void scanBlockSSE2(const char* block, StructuralMasks& masks) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    masks.quotes = 0;
+    masks.commas = 0;
+    masks.newlines = 0;
+    for (int i = 0; i < SCAN_BLOCK_SIZE; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(block + i));
+        masks.quotes |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)) << i;
+        masks.commas |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, comma)) << i;
+        masks.newlines |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)) << i;
+    }
+}
+
+__attribute__((target("avx2")))
+static void scanBlockAVX2(const char* block, StructuralMasks& masks) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    __m256i lo = _mm256_loadu_si256((const __m256i*)block);
+    __m256i hi = _mm256_loadu_si256((const __m256i*)(block + 32));
+    masks.quotes = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote))
+                 | (unsigned long long)(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)) << 32;
+    masks.commas = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, comma))
+                 | (unsigned long long)(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, comma)) << 32;
+    masks.newlines = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline))
+                   | (unsigned long long)(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)) << 32;
+}
+
+static ScanKernel bestSupportedKernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SCAN_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SCAN_SSE2;
+    return SCAN_SCALAR;
+}
+
+static ScanKernel activeKernel = bestSupportedKernel();
+
+static BlockScanFunc kernelFunc(ScanKernel kernel) {
+    switch (kernel) {
+        case SCAN_AVX2: return scanBlockAVX2;
+        case SCAN_SSE2: return scanBlockSSE2;
+        default: return scanBlockScalar;
+    }
+}
+
+BlockScanFunc getBlockScanner() {
+    return kernelFunc(activeKernel);
+}
+
+ScanKernel getScanKernel() {
+    return activeKernel;
+}
+
+void setScanKernel(ScanKernel kernel) {
+    ScanKernel best = bestSupportedKernel();
+    activeKernel = kernel > best ? best : kernel;
+}
+
+long countQuotes(const char* data, long begin, long end) {
+    BlockScanFunc scan = getBlockScanner();
+    StructuralMasks masks;
+    long quotes = 0;
+    long pos = begin;
+    for (; pos + SCAN_BLOCK_SIZE <= end; pos += SCAN_BLOCK_SIZE) {
+        scan(data + pos, masks);
+        quotes += __builtin_popcountll(masks.quotes);
+    }
+    for (; pos < end; pos++) {
+        if (data[pos] == '"') quotes++;
+    }
+    return quotes;
+}
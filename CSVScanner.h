@@ -0,0 +1,111 @@
+// CSVScanner.h
+#ifndef CSV_SCANNER_H
+#define CSV_SCANNER_H
+
+// Bitmasks of the structural characters in one 64-byte block (bit i = byte i)
+struct StructuralMasks {
+    unsigned long long quotes;
+    unsigned long long commas;
+    unsigned long long newlines;
+};
+
+enum ScanKernel {
+    SCAN_SCALAR,
+    SCAN_SSE2,
+    SCAN_AVX2
+};
+
+const int SCAN_BLOCK_SIZE = 64;
+
+typedef void (*BlockScanFunc)(const char* block, StructuralMasks& masks);
+
+// Kernel picked from the CPU's features on first use (AVX2 > SSE2 > scalar)
+BlockScanFunc getBlockScanner();
+ScanKernel getScanKernel();
+
+// Forces a kernel (e.g. for comparing against the scalar fallback).
+// Falls back to the best supported kernel if the CPU lacks the requested one.
+void setScanKernel(ScanKernel kernel);
+
+// Number of '"' bytes in [data + begin, data + end)
+long countQuotes(const char* data, long begin, long end);
+
+// Walks the unquoted ',' and '\n' of [begin, end) one 64-byte block at a
+// time. Quote state is tracked as a prefix-XOR of the quote bitmask, with
+// one carry bit between blocks. Bytes up to readable may be loaded, so a
+// range that ends inside a larger buffer is scanned in place; only a block
+// running past readable (the true end of the buffer) is copied and padded.
+class StructuralScanner {
+private:
+    const char* data;
+    long end;
+    long readable;
+    long blockStart;           // offset of the block whose bits are in pending
+    long nextBlock;
+    unsigned long long pending;
+    bool inQuotes;             // quote state at nextBlock
+    bool wantCommas;
+    BlockScanFunc scan;
+
+    void loadBlock() {
+        StructuralMasks masks;
+        if (readable - nextBlock >= SCAN_BLOCK_SIZE) {
+            scan(data + nextBlock, masks);
+        } else {
+            // Never read past the buffer: copy its tail into a padded block
+            char tail[SCAN_BLOCK_SIZE] = {0};
+            for (long i = 0; i < readable - nextBlock; i++) {
+                tail[i] = data[nextBlock + i];
+            }
+            scan(tail, masks);
+        }
+
+        // Drop bytes past end so they affect neither quote state nor output
+        if (end - nextBlock < SCAN_BLOCK_SIZE) {
+            unsigned long long inRange = (1ULL << (end - nextBlock)) - 1;
+            masks.quotes &= inRange;
+            masks.commas &= inRange;
+            masks.newlines &= inRange;
+        }
+
+        // Bit i set iff an odd number of quotes occur at or before byte i
+        unsigned long long quoted = masks.quotes;
+        quoted ^= quoted << 1;
+        quoted ^= quoted << 2;
+        quoted ^= quoted << 4;
+        quoted ^= quoted << 8;
+        quoted ^= quoted << 16;
+        quoted ^= quoted << 32;
+        if (inQuotes) quoted = ~quoted;
+        inQuotes = (__builtin_popcountll(masks.quotes) & 1) ? !inQuotes : inQuotes;
+
+        unsigned long long structural = masks.newlines;
+        if (wantCommas) structural |= masks.commas;
+        pending = structural & ~quoted;
+
+        blockStart = nextBlock;
+        nextBlock += SCAN_BLOCK_SIZE;
+    }
+
+public:
+    StructuralScanner(const char* buffer, long begin, long limit, long bufferEnd,
+                      bool startInQuotes, bool commas)
+        : data(buffer), end(limit), readable(bufferEnd), blockStart(begin), nextBlock(begin),
+          pending(0), inQuotes(startInQuotes), wantCommas(commas), scan(getBlockScanner()) {}
+
+    StructuralScanner(const char* buffer, long begin, long limit, bool startInQuotes, bool commas)
+        : StructuralScanner(buffer, begin, limit, limit, startInQuotes, commas) {}
+
+    // Offset of the next unquoted structural byte, or end if there is none
+    long next() {
+        while (pending == 0) {
+            if (nextBlock >= end) return end;
+            loadBlock();
+        }
+        long pos = blockStart + __builtin_ctzll(pending);
+        pending &= pending - 1;
+        return pos;
+    }
+};
+
+#endif
@@ -0,0 +1,143 @@
+// FileWatcher.cpp
+#include "FileWatcher.h"
+#include "StringUtils.h"
+
+#define SYS_READ 0
+#define SYS_CLOSE 3
+#define SYS_POLL 7
+#define SYS_INOTIFY_ADD_WATCH 254
+#define SYS_INOTIFY_RM_WATCH 255
+#define SYS_INOTIFY_INIT1 294
+
+#define IN_MODIFY 0x2
+#define IN_ATTRIB 0x4
+#define IN_DELETE_SELF 0x400
+#define IN_MOVE_SELF 0x800
+#define IN_IGNORED 0x8000
+#define IN_NONBLOCK 04000
+#define WATCH_MASK (IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF)
+#define POLL_IN 1
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+
+struct PollFd {
+    int fd;
+    short events;
+    short revents;
+};
+
+// Fixed part of a struct inotify_event; len bytes of name follow it
+struct InotifyEvent {
+    int wd;
+    unsigned int mask;
+    unsigned int cookie;
+    unsigned int len;
+};
+
+FileWatcher::FileWatcher() : inotifyFd(-1), watchFd(-1), path(nullptr) {}
+
+FileWatcher::~FileWatcher() {
+    close();
+}
+
+bool FileWatcher::watch(const char* filename) {
+    close();
+
+    long fd = syscall3(SYS_INOTIFY_INIT1, IN_NONBLOCK, 0, 0);
+    if (fd < 0) return false;
+
+    long wd = syscall3(SYS_INOTIFY_ADD_WATCH, fd, (long)filename, WATCH_MASK);
+    if (wd < 0) {
+        syscall3(SYS_CLOSE, fd, 0, 0);
+        return false;
+    }
+
+    inotifyFd = fd;
+    watchFd = wd;
+    copyString(path, filename);
+    return true;
+}
+
+void FileWatcher::close() {
+    if (inotifyFd >= 0) {
+        syscall3(SYS_CLOSE, inotifyFd, 0, 0);
+        inotifyFd = -1;
+    }
+    watchFd = -1;
+    if (path) delete[] path;
+    path = nullptr;
+}
+
+bool FileWatcher::rewatch() {
+    // Adding a watch for an inode that is already watched returns its
+    // existing descriptor, so a new descriptor means a different file
+    long wd = syscall3(SYS_INOTIFY_ADD_WATCH, inotifyFd, (long)path, WATCH_MASK);
+    if (wd < 0) wd = -1;
+    if (wd == watchFd) return false;
+
+    if (watchFd >= 0) syscall3(SYS_INOTIFY_RM_WATCH, inotifyFd, watchFd, 0);
+    watchFd = wd;
+    return true;
+}
+
+WatchEvent FileWatcher::wait(int timeoutMs, long extraFd) {
+    PollFd fds[2];
+    int count = 0;
+    int extraSlot = -1;
+
+    // The name was missing; watch the file if it is back. Callers re-check
+    // the file after every wait, so this is not reported as a change.
+    if (inotifyFd >= 0 && watchFd < 0) rewatch();
+
+    if (inotifyFd >= 0) {
+        fds[count].fd = (int)inotifyFd;
+        fds[count].events = POLL_IN;
+        fds[count].revents = 0;
+        count++;
+    }
+    if (extraFd >= 0) {
+        extraSlot = count;
+        fds[count].fd = (int)extraFd;
+        fds[count].events = POLL_IN;
+        fds[count].revents = 0;
+        count++;
+    }
+
+    // With no descriptors poll() simply sleeps, which is the polling fallback
+    long ready = syscall3(SYS_POLL, (long)fds, count, timeoutMs);
+    if (ready <= 0) {
+        // A file that appeared while the name had no watch
+        if (inotifyFd >= 0 && watchFd < 0 && rewatch()) return WATCH_REPLACED;
+        return WATCH_TIMEOUT;
+    }
+
+    if (extraSlot >= 0 && fds[extraSlot].revents) return WATCH_INPUT;
+
+    // Drain queued events; one re-check covers all of them
+    long events[512];
+    long bytes;
+    bool lost = false;      // the kernel dropped the watch (file deleted)
+    bool renamed = false;   // the file may no longer be the one at path
+    while ((bytes = syscall3(SYS_READ, inotifyFd, (long)events, sizeof(events))) > 0) {
+        const char* cursor = (const char*)events;
+        const char* end = cursor + bytes;
+        while (cursor < end) {
+            const InotifyEvent* event = (const InotifyEvent*)cursor;
+            if ((event->mask & IN_IGNORED) && event->wd == watchFd) {
+                watchFd = -1;
+                lost = true;
+            }
+            if (event->mask & (IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF)) renamed = true;
+            cursor += sizeof(InotifyEvent) + event->len;
+        }
+    }
+
+    if (lost) {
+        rewatch();
+        return WATCH_REPLACED;
+    }
+    // IN_ATTRIB also covers the link count dropping when the file is
+    // renamed over, so any of these re-checks what the name refers to
+    if (renamed && rewatch()) return WATCH_REPLACED;
+    return WATCH_CHANGED;
+}
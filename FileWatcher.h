@@ -0,0 +1,47 @@
+// FileWatcher.h
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+// Result of FileWatcher::wait
+enum WatchEvent {
+    WATCH_CHANGED,   // the file was written to or its attributes changed
+    WATCH_REPLACED,  // the name now refers to another file, or to none
+    WATCH_TIMEOUT,   // nothing happened (or inotify is unavailable)
+    WATCH_INPUT      // the extra descriptor (e.g. stdin) became readable
+};
+
+// Waits for changes to a file using inotify. The watch follows the name,
+// not the inode: when the file is renamed over (editor saves), moved away
+// or deleted (log rotation), the watch is moved to whatever file the name
+// refers to next. When inotify cannot be used the watcher degrades to
+// polling: wait() just sleeps for the timeout and callers re-check the
+// file every time.
+class FileWatcher {
+private:
+    long inotifyFd;
+    long watchFd;   // inotify watch descriptor, -1 while the name is missing
+    char* path;
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Re-points the watch at the file path names now; true if that is not
+    // the file watched so far
+    bool rewatch();
+
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    // Starts watching filename; returns false if only polling is available
+    bool watch(const char* filename);
+    void close();
+
+    bool isWatching() const { return inotifyFd >= 0; }
+
+    // Blocks until the file changes, extraFd is readable or timeoutMs
+    // elapses. Pass extraFd < 0 to wait on the file only.
+    WatchEvent wait(int timeoutMs, long extraFd);
+};
+
+#endif
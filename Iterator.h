@@ -4,13 +4,13 @@
 
 #include "Student.h"
 
-// Base iterator interface
+// Base iterator interface; students are read-only through it
 template<typename RollNumType, typename CourseIDType>
 class Iterator {
 public:
     virtual ~Iterator() {}
     virtual bool hasNext() const = 0;
-    virtual Student<RollNumType, CourseIDType>* next() = 0;
+    virtual const Student<RollNumType, CourseIDType>* next() = 0;
     virtual void reset() = 0;
 };
 
@@ -18,19 +18,19 @@ public:
 template<typename RollNumType, typename CourseIDType>
 class InsertionOrderIterator : public Iterator<RollNumType, CourseIDType> {
 private:
-    Student<RollNumType, CourseIDType>** students;
+    const Student<RollNumType, CourseIDType>* const* students;
     int size;
     int currentIndex;
 
 public:
-    InsertionOrderIterator(Student<RollNumType, CourseIDType>** stds, int sz)
+    InsertionOrderIterator(const Student<RollNumType, CourseIDType>* const* stds, int sz)
         : students(stds), size(sz), currentIndex(0) {}
     
     bool hasNext() const override {
         return currentIndex < size;
     }
     
-    Student<RollNumType, CourseIDType>* next() override {
+    const Student<RollNumType, CourseIDType>* next() override {
         if (hasNext()) {
             return students[currentIndex++];
         }
@@ -46,19 +46,19 @@ public:
 template<typename RollNumType, typename CourseIDType>
 class SortedOrderIterator : public Iterator<RollNumType, CourseIDType> {
 private:
-    Student<RollNumType, CourseIDType>** students;
+    const Student<RollNumType, CourseIDType>* const* students;
     int size;
     int currentIndex;
 
 public:
-    SortedOrderIterator(Student<RollNumType, CourseIDType>** stds, int sz)
+    SortedOrderIterator(const Student<RollNumType, CourseIDType>* const* stds, int sz)
         : students(stds), size(sz), currentIndex(0) {}
     
     bool hasNext() const override {
         return currentIndex < size;
     }
     
-    Student<RollNumType, CourseIDType>* next() override {
+    const Student<RollNumType, CourseIDType>* next() override {
         if (hasNext()) {
             return students[currentIndex++];
         }
@@ -74,19 +74,19 @@ public:
 template<typename RollNumType, typename CourseIDType>
 class FilteredIterator : public Iterator<RollNumType, CourseIDType> {
 private:
-    Student<RollNumType, CourseIDType>** students;
+    const Student<RollNumType, CourseIDType>* const* students;
     int size;
     int currentIndex;
 
 public:
-    FilteredIterator(Student<RollNumType, CourseIDType>** stds, int sz)
+    FilteredIterator(const Student<RollNumType, CourseIDType>* const* stds, int sz)
         : students(stds), size(sz), currentIndex(0) {}
     
     bool hasNext() const override {
         return currentIndex < size;
     }
     
-    Student<RollNumType, CourseIDType>* next() override {
+    const Student<RollNumType, CourseIDType>* next() override {
         if (hasNext()) {
             return students[currentIndex++];
         }
@@ -0,0 +1,62 @@
+// MappedFile.cpp
+#include "MappedFile.h"
+
+#define SYS_OPEN 2
+#define SYS_CLOSE 3
+#define SYS_LSEEK 8
+#define SYS_MMAP 9
+#define SYS_MUNMAP 11
+#define SYS_MADVISE 28
+
+#define OPEN_RDONLY 0
+#define SEEK_FROM_END 2
+#define MMAP_PROT_READ 1
+#define MMAP_PRIVATE 2
+#define MADVISE_SEQUENTIAL 2
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+extern "C" long syscall6(long number, long arg1, long arg2, long arg3,
+                         long arg4, long arg5, long arg6);
+
+// Raw syscalls return -errno in [-4095, -1] on failure
+static bool syscallFailed(long result) {
+    return (unsigned long)result >= (unsigned long)-4095L;
+}
+
+MappedFile::MappedFile() : data(nullptr), size(0) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const char* filename) {
+    close();
+
+    long fd = syscall3(SYS_OPEN, (long)filename, OPEN_RDONLY, 0);
+    if (fd < 0) return false;
+
+    long fileSize = syscall3(SYS_LSEEK, fd, 0, SEEK_FROM_END);
+    if (fileSize <= 0) {
+        syscall3(SYS_CLOSE, fd, 0, 0);
+        return false;
+    }
+
+    long addr = syscall6(SYS_MMAP, 0, fileSize, MMAP_PROT_READ, MMAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    syscall3(SYS_CLOSE, fd, 0, 0);
+    if (syscallFailed(addr)) return false;
+
+    syscall3(SYS_MADVISE, addr, fileSize, MADVISE_SEQUENTIAL);
+
+    data = (char*)addr;
+    size = fileSize;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data) {
+        syscall3(SYS_MUNMAP, (long)data, size, 0);
+        data = nullptr;
+        size = 0;
+    }
+}
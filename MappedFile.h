@@ -0,0 +1,29 @@
+// MappedFile.h
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+// Read-only, private memory mapping of a whole file.
+// The pages are never copied: callers parse directly out of getData().
+class MappedFile {
+private:
+    char* data;
+    long size;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Maps the file and hints sequential access. Fails for empty or
+    // non-seekable files (pipes), in which case callers fall back to read().
+    bool open(const char* filename);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    const char* getData() const { return data; }
+    long getSize() const { return size; }
+};
+
+#endif
@@ -3,7 +3,7 @@
 #define PARALLEL_SORT_H
 
 #include "Student.h"
-#include <pthread.h>
+#include "ThreadPool.h"
 
 // System call definitions for clock_gettime (Linux x86-64 syscall number 228)
 #define SYS_CLOCK_GETTIME 228
@@ -12,17 +12,6 @@
 // Declare syscall3 external function from syscall.s
 extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
 
-// Thread data structure
-template<typename RollNumType, typename CourseIDType>
-struct ThreadData {
-    Student<RollNumType, CourseIDType>** array;
-    int left;
-    int right;
-    int threadId;
-    long long timeElapsed; // in microseconds
-    bool (*compare)(const Student<RollNumType, CourseIDType>&, const Student<RollNumType, CourseIDType>&);
-};
-
 // Get current time in microseconds
 inline long long getCurrentTimeMicros() {
     struct timespec {
@@ -40,215 +29,720 @@ inline long long getCurrentTimeMicros() {
     return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000LL;
 }
 
-// Merge function for merge sort
+// Runs shorter than this are sorted by insertion sort
+const int INSERTION_SORT_CUTOFF = 16;
+
+// The sort routines below work on any array of Items ordered by a Less
+// functor; this one orders Student pointers with a Student comparator
 template<typename RollNumType, typename CourseIDType>
-void merge(Student<RollNumType, CourseIDType>** arr, int left, int mid, int right,
-           bool (*compare)(const Student<RollNumType, CourseIDType>&, const Student<RollNumType, CourseIDType>&)) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-    
-    Student<RollNumType, CourseIDType>** L = new Student<RollNumType, CourseIDType>*[n1];
-    Student<RollNumType, CourseIDType>** R = new Student<RollNumType, CourseIDType>*[n2];
+struct StudentPointerLess {
+    bool (*compare)(const Student<RollNumType, CourseIDType>&, const Student<RollNumType, CourseIDType>&);
     
-    for (int i = 0; i < n1; i++)
-        L[i] = arr[left + i];
-    for (int j = 0; j < n2; j++)
-        R[j] = arr[mid + 1 + j];
+    explicit StudentPointerLess(bool (*cmp)(const Student<RollNumType, CourseIDType>&,
+                                            const Student<RollNumType, CourseIDType>&))
+        : compare(cmp) {}
     
-    int i = 0, j = 0, k = left;
+    bool operator()(const Student<RollNumType, CourseIDType>* a,
+                    const Student<RollNumType, CourseIDType>* b) const {
+        return compare(*a, *b);
+    }
+};
+
+// Merges src[left..mid] and src[mid+1..right] into dst[left..right]. Stable:
+// a right element goes first only if it compares strictly less.
+template<typename Item, typename Less>
+void mergeRuns(const Item* src, Item* dst, int left, int mid, int right, const Less& less) {
+    int i = left, j = mid + 1, k = left;
     
-    while (i < n1 && j < n2) {
-        if (compare(*L[i], *R[j])) { 
-            arr[k] = L[i];
-            i++;
+    while (i <= mid && j <= right) {
+        if (less(src[j], src[i])) {
+            dst[k++] = src[j++];
         } else {
-            arr[k] = R[j];
-            j++;
+            dst[k++] = src[i++];
         }
-        k++;
     }
-    
-    while (i < n1) {
-        arr[k] = L[i];
-        i++;
-        k++;
+    while (i <= mid) dst[k++] = src[i++];
+    while (j <= right) dst[k++] = src[j++];
+}
+
+// Stable insertion sort of arr[left..right]
+template<typename Item, typename Less>
+void insertionSort(Item* arr, int left, int right, const Less& less) {
+    for (int i = left + 1; i <= right; i++) {
+        Item item = arr[i];
+        int j = i;
+        while (j > left && less(item, arr[j - 1])) {
+            arr[j] = arr[j - 1];
+            j--;
+        }
+        arr[j] = item;
     }
-    
-    while (j < n2) {
-        arr[k] = R[j];
-        j++;
-        k++;
+}
+
+// Sorts arr[left..right] into arr (or into scratch when toScratch) without
+// allocating. Levels alternate between the two buffers: each merge reads
+// the halves from the buffer the level below wrote. Leaves copy their
+// range from arr first when they sort into scratch.
+template<typename Item, typename Less>
+void pingPongSort(Item* arr, Item* scratch, int left, int right, bool toScratch, const Less& less) {
+    if (right - left < INSERTION_SORT_CUTOFF) {
+        if (toScratch) {
+            for (int i = left; i <= right; i++) scratch[i] = arr[i];
+        }
+        insertionSort(toScratch ? scratch : arr, left, right, less);
+        return;
+    }
+    int mid = left + (right - left) / 2;
+    pingPongSort(arr, scratch, left, mid, !toScratch, less);
+    pingPongSort(arr, scratch, mid + 1, right, !toScratch, less);
+    if (toScratch) {
+        mergeRuns(arr, scratch, left, mid, right, less);
+    } else {
+        mergeRuns(scratch, arr, left, mid, right, less);
     }
-    
-    delete[] L;
-    delete[] R;
 }
 
-// Merge sort implementation
+// Merge sort of arr[left..right] using scratch[left..right] as the second buffer
 template<typename RollNumType, typename CourseIDType>
-void mergeSort(Student<RollNumType, CourseIDType>** arr, int left, int right, 
+void mergeSort(Student<RollNumType, CourseIDType>** arr, Student<RollNumType, CourseIDType>** scratch,
+               int left, int right, 
                bool (*compare)(const Student<RollNumType, CourseIDType>&, const Student<RollNumType, CourseIDType>&)) {
     if (left < right) {
-        int mid = left + (right - left) / 2;
-        mergeSort(arr, left, mid, compare);
-        mergeSort(arr, mid + 1, right, compare);
-        merge(arr, left, mid, right, compare);
+        pingPongSort(arr, scratch, left, right, false, StudentPointerLess<RollNumType, CourseIDType>(compare));
     }
 }
 
-// Thread function for sorting
+// Merge sort implementation; allocates one scratch buffer for the range
 template<typename RollNumType, typename CourseIDType>
-void* threadSort(void* arg) {
-    ThreadData<RollNumType, CourseIDType>* data = 
-        static_cast<ThreadData<RollNumType, CourseIDType>*>(arg);
-    
-    if (data->left <= data->right) {
-        long long startTime = getCurrentTimeMicros();
-        
-        mergeSort(data->array, data->left, data->right, data->compare); 
-        
-        long long endTime = getCurrentTimeMicros();
-        
-        if (endTime >= startTime) {
-            data->timeElapsed = endTime - startTime;
+void mergeSort(Student<RollNumType, CourseIDType>** arr, int left, int right, 
+               bool (*compare)(const Student<RollNumType, CourseIDType>&, const Student<RollNumType, CourseIDType>&)) {
+    if (left < right) {
+        Student<RollNumType, CourseIDType>** scratch = new Student<RollNumType, CourseIDType>*[right - left + 1];
+        mergeSort(arr + left, scratch, 0, right - left, compare);
+        delete[] scratch;
+    }
+}
+
+// Merge path: how many of the first `diagonal` merged elements come from
+// left[0..n1). Matches mergeRuns(): a right element goes first only if it
+// compares strictly less than the left one.
+template<typename Item, typename Less>
+int mergePathSplit(const Item* left, int n1, const Item* right, int n2, int diagonal, const Less& less) {
+    int lo = diagonal > n2 ? diagonal - n2 : 0;
+    int hi = diagonal < n1 ? diagonal : n1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (!less(right[diagonal - mid - 1], left[mid])) {
+            lo = mid + 1;
         } else {
-            data->timeElapsed = 0;
+            hi = mid;
         }
-        
-        if (data->timeElapsed == 0) {
-            data->timeElapsed = 1; 
+    }
+    return lo;
+}
+
+// Fixed-width sort keys of a student with the student itself. Comparing
+// keys settles most comparisons without touching either Student; only
+// when every key is equal or missing (0) is the full comparator used.
+template<typename RollNumType, typename CourseIDType>
+struct KeyedStudent {
+    unsigned long long key;
+    unsigned long long tieKey;    // decides between equal keys
+    unsigned long long rollKey;   // decides between equal key and tieKey
+    Student<RollNumType, CourseIDType>* student;
+};
+
+// Orders KeyedStudents exactly like compare orders the students, as long
+// as the keys were built for compare (see ParallelSort::sortByName)
+template<typename RollNumType, typename CourseIDType>
+struct KeyedStudentLess {
+    bool (*compare)(const Student<RollNumType, CourseIDType>&, const Student<RollNumType, CourseIDType>&);
+    
+    explicit KeyedStudentLess(bool (*cmp)(const Student<RollNumType, CourseIDType>&,
+                                          const Student<RollNumType, CourseIDType>&))
+        : compare(cmp) {}
+    
+    bool operator()(const KeyedStudent<RollNumType, CourseIDType>& a,
+                    const KeyedStudent<RollNumType, CourseIDType>& b) const {
+        if (a.key != b.key) {
+            if (a.key && b.key) return a.key < b.key;
+        } else if (a.tieKey != b.tieKey) {
+            if (a.tieKey && b.tieKey) return a.tieKey < b.tieKey;
+        } else if (a.rollKey != b.rollKey && a.rollKey && b.rollKey) {
+            return a.rollKey < b.rollKey;
         }
+        return compare(*a.student, *b.student);
+    }
+};
 
-    } else {
-        data->timeElapsed = 0;
+// Up to 8 lowercased bytes of text, big-endian and zero padded, so packed
+// words compare like my_stricmp compares the text. Sets `ended` if the
+// terminator falls inside those 8 bytes.
+inline unsigned long long packLowercase(const char* text, bool& ended) {
+    unsigned long long packed = 0;
+    int i = 0;
+    for (; i < 8 && text[i]; i++) {
+        packed = (packed << 8) | (unsigned char)my_tolower(text[i]);
     }
-    
-    return nullptr;
+    ended = i < 8;
+    return i == 0 ? 0 : packed << (8 * (8 - i));
 }
 
-// Parallel sort with multiple threads
+// Fork-join merge sort on a work-stealing scheduler. Each worker owns a
+// deque of forked jobs: it pushes and pops its own at the bottom, while
+// idle workers steal the oldest (largest) job from the top of another
+// worker's deque. The scratch buffer is shared the way pingPongSort uses
+// it, and merges are split at merge-path points. The sort is stable, so
+// the result is identical to a serial mergeSort for any number of workers.
 template<typename RollNumType, typename CourseIDType>
 class ParallelSort {
+public:
+    // Ranges of at most this many elements are sorted without forking
+    static const int SORT_CUTOFF = 1024;
+    // Merge slices of at most this many outputs run sequentially
+    static const int MERGE_CUTOFF = 4096;
+
 private:
+    typedef Student<RollNumType, CourseIDType> StudentType;
+    
+    enum JobKind { SORT_JOB, MERGE_JOB };
+    
+    struct Worker;
+    
+    // The arrays and ordering of one sort: Student pointers, or
+    // KeyedStudents for the key-based modes
+    template<typename Item, typename Less>
+    struct SortRun {
+        Item* array;
+        Item* scratch;
+        Less less;
+    };
+    
+    // A forked piece of work. SORT_JOB sorts [left..right] into array, or
+    // into scratch when toScratch (see pingPongSort); MERGE_JOB writes
+    // outputs [outFirst, outEnd) of merging [left..mid] with [mid+1..right]
+    // from the other buffer into that one. execute knows the SortRun's
+    // types. Jobs live on the forking worker's stack until joined.
+    struct Job {
+        void (*execute)(ParallelSort& sorter, Worker& w, Job& job);
+        void* sortRun;
+        JobKind kind;
+        bool toScratch;
+        int left;
+        int mid;
+        int right;
+        int outFirst;
+        int outEnd;
+        bool done;   // set under idleLock once a thief has run the job
+    };
+    
+    static const int DEQUE_CAPACITY = 256;
+    static const int MAX_KEY_CHUNKS = 64;
+    
+    struct Worker {
+        ParallelSort* owner;
+        int id;
+        Job* deque[DEQUE_CAPACITY];
+        int top;      // next job to steal
+        int bottom;   // one past the owner's newest job
+        pthread_mutex_t lock;
+        unsigned int victim;   // where the next steal attempt starts
+        long long busyTime;    // in microseconds
+        long long idleTime;
+        int jobsRun;
+        int steals;
+    };
+    
     int numThreads;
-    pthread_t* threads;
-    ThreadData<RollNumType, CourseIDType>* threadData;
-
-public:
-    ParallelSort(int threads = 2) : numThreads(threads), threads(nullptr), threadData(nullptr) {
-        this->threads = new pthread_t[numThreads];
-        this->threadData = new ThreadData<RollNumType, CourseIDType>[numThreads];
+    ThreadPool& pool;
+    ThreadPool::Future* pending;
+    Worker* workers;
+    
+    // Sleeping idle workers and job completion
+    pthread_mutex_t idleLock;
+    pthread_cond_t idleCond;
+    int queued;      // jobs sitting in deques
+    bool finished;   // the root job is done
+    
+    // Second merge buffers and key entries. They are kept between sorts
+    // and only grow, so repeated sorts do not allocate.
+    StudentType** pointerScratch;
+    int pointerCapacity;
+    KeyedStudent<RollNumType, CourseIDType>* keyEntries;
+    KeyedStudent<RollNumType, CourseIDType>* keyScratch;
+    int keyCapacity;
+    
+    ParallelSort(const ParallelSort&) = delete;
+    ParallelSort& operator=(const ParallelSort&) = delete;
+    
+    // Makes job stealable; false if the deque is full (run it inline)
+    bool push(Worker& w, Job* job) {
+        pthread_mutex_lock(&w.lock);
+        if (w.bottom == DEQUE_CAPACITY) {
+            pthread_mutex_unlock(&w.lock);
+            return false;
+        }
+        w.deque[w.bottom++] = job;
+        pthread_mutex_unlock(&w.lock);
+        
+        pthread_mutex_lock(&idleLock);
+        queued++;
+        pthread_cond_signal(&idleCond);
+        pthread_mutex_unlock(&idleLock);
+        return true;
     }
     
-    ~ParallelSort() {
-        if (threads) delete[] threads;
-        if (threadData) delete[] threadData;
+    // Takes job back from the bottom of the owner's deque unless it was stolen
+    bool popOwn(Worker& w, Job* job) {
+        pthread_mutex_lock(&w.lock);
+        bool found = w.bottom > w.top && w.deque[w.bottom - 1] == job;
+        if (found) {
+            w.bottom--;
+            if (w.bottom == w.top) w.top = w.bottom = 0;
+        }
+        pthread_mutex_unlock(&w.lock);
+        
+        if (found) {
+            pthread_mutex_lock(&idleLock);
+            queued--;
+            pthread_mutex_unlock(&idleLock);
+        }
+        return found;
+    }
+    
+    // Oldest job of some other worker, or nullptr
+    Job* steal(Worker& w) {
+        for (int attempt = 0; attempt < numThreads; attempt++) {
+            Worker& v = workers[(w.victim + attempt) % numThreads];
+            if (&v == &w) continue;
+            
+            Job* job = nullptr;
+            pthread_mutex_lock(&v.lock);
+            if (v.bottom > v.top) {
+                job = v.deque[v.top++];
+                if (v.bottom == v.top) v.top = v.bottom = 0;
+            }
+            pthread_mutex_unlock(&v.lock);
+            
+            if (job) {
+                w.victim = (w.victim + attempt) % numThreads;
+                w.steals++;
+                pthread_mutex_lock(&idleLock);
+                queued--;
+                pthread_mutex_unlock(&idleLock);
+                return job;
+            }
+        }
+        w.victim++;
+        return nullptr;
+    }
+    
+    void runStolen(Worker& w, Job* job) {
+        run(w, *job);
+        pthread_mutex_lock(&idleLock);
+        job->done = true;
+        pthread_cond_broadcast(&idleCond);
+        pthread_mutex_unlock(&idleLock);
+    }
+    
+    // Sleeps until woken; idle time is not counted as busy
+    void sleep(Worker& w) {
+        long long start = getCurrentTimeMicros();
+        pthread_cond_wait(&idleCond, &idleLock);
+        w.idleTime += getCurrentTimeMicros() - start;
+    }
+    
+    // Waits for a forked job: runs it inline if it is still in the deque,
+    // otherwise steals other work until the thief has finished it
+    void join(Worker& w, Job* job) {
+        if (popOwn(w, job)) {
+            run(w, *job);
+            return;
+        }
+        pthread_mutex_lock(&idleLock);
+        while (!job->done) {
+            if (queued > 0) {
+                pthread_mutex_unlock(&idleLock);
+                Job* other = steal(w);
+                if (other) runStolen(w, other);
+                pthread_mutex_lock(&idleLock);
+            } else {
+                sleep(w);
+            }
+        }
+        pthread_mutex_unlock(&idleLock);
+    }
+    
+    // Runs first while second is open to thieves, then joins second
+    void fork(Worker& w, Job& first, Job& second) {
+        if (push(w, &second)) {
+            run(w, first);
+            join(w, &second);
+        } else {
+            run(w, first);
+            run(w, second);
+        }
+    }
+    
+    template<typename Item, typename Less>
+    static Job makeJob(SortRun<Item, Less>& sortRun, JobKind kind, bool toScratch,
+                       int left, int mid, int right, int outFirst, int outEnd) {
+        Job job;
+        job.execute = execute<Item, Less>;
+        job.sortRun = &sortRun;
+        job.kind = kind;
+        job.toScratch = toScratch;
+        job.left = left;
+        job.mid = mid;
+        job.right = right;
+        job.outFirst = outFirst;
+        job.outEnd = outEnd;
+        job.done = false;
+        return job;
+    }
+    
+    template<typename Item, typename Less>
+    static void execute(ParallelSort& sorter, Worker& w, Job& job) {
+        SortRun<Item, Less>& sortRun = *static_cast<SortRun<Item, Less>*>(job.sortRun);
+        if (job.kind == SORT_JOB) {
+            sorter.runSort(w, sortRun, job.left, job.right, job.toScratch);
+        } else {
+            sorter.runSlice(w, sortRun, job);
+        }
     }
     
-    // FIXED: Corrected sort method with proper merging
-    void sort(Student<RollNumType, CourseIDType>** array, int size,
-              bool (*compare)(const Student<RollNumType, CourseIDType>&, const Student<RollNumType, CourseIDType>&)) {
+    void run(Worker& w, Job& job) {
+        w.jobsRun++;
+        job.execute(*this, w, job);
+    }
+    
+    // Same recursion as pingPongSort, with the halves and the merge forked
+    template<typename Item, typename Less>
+    void runSort(Worker& w, SortRun<Item, Less>& sortRun, int left, int right, bool toScratch) {
+        if (right - left + 1 <= SORT_CUTOFF) {
+            pingPongSort(sortRun.array, sortRun.scratch, left, right, toScratch, sortRun.less);
+            return;
+        }
+        int mid = left + (right - left) / 2;
+        Job first = makeJob(sortRun, SORT_JOB, !toScratch, left, 0, mid, 0, 0);
+        Job second = makeJob(sortRun, SORT_JOB, !toScratch, mid + 1, 0, right, 0, 0);
+        fork(w, first, second);
         
-        if (size <= 0) return;
+        Job merged = makeJob(sortRun, MERGE_JOB, toScratch, left, mid, right, 0, right - left + 1);
+        run(w, merged);
+    }
+    
+    template<typename Item, typename Less>
+    void runSlice(Worker& w, SortRun<Item, Less>& sortRun, Job& job) {
+        if (job.outEnd - job.outFirst > MERGE_CUTOFF) {
+            int half = job.outFirst + (job.outEnd - job.outFirst) / 2;
+            Job first = makeJob(sortRun, MERGE_JOB, job.toScratch, job.left, job.mid, job.right,
+                                job.outFirst, half);
+            Job second = makeJob(sortRun, MERGE_JOB, job.toScratch, job.left, job.mid, job.right,
+                                 half, job.outEnd);
+            fork(w, first, second);
+            return;
+        }
         
-        int chunkSize = size / numThreads;
+        const Item* src = job.toScratch ? sortRun.array : sortRun.scratch;
+        Item* out = (job.toScratch ? sortRun.scratch : sortRun.array) + job.left;
+        const Item* leftRun = src + job.left;
+        const Item* rightRun = src + job.mid + 1;
+        int n1 = job.mid - job.left + 1;
+        int n2 = job.right - job.mid;
         
-        // Create threads for sorting
-        for (int i = 0; i < numThreads; i++) {
-            threadData[i].array = array;
-            threadData[i].left = i * chunkSize;
-            threadData[i].right = (i == numThreads - 1) ? (size - 1) : ((i + 1) * chunkSize - 1);
-            
-            if (threadData[i].left > threadData[i].right) {
-                threadData[i].right = threadData[i].left - 1;
+        int i = mergePathSplit(leftRun, n1, rightRun, n2, job.outFirst, sortRun.less);
+        int j = job.outFirst - i;
+        int iEnd = mergePathSplit(leftRun, n1, rightRun, n2, job.outEnd, sortRun.less);
+        int jEnd = job.outEnd - iEnd;
+        
+        int k = job.outFirst;
+        while (i < iEnd && j < jEnd) {
+            if (sortRun.less(rightRun[j], leftRun[i])) {
+                out[k++] = rightRun[j++];
+            } else {
+                out[k++] = leftRun[i++];
             }
-
-            threadData[i].threadId = i;
-            threadData[i].timeElapsed = 0;
-            threadData[i].compare = compare;
-            
-            pthread_create(&threads[i], nullptr, 
-                          threadSort<RollNumType, CourseIDType>, 
-                          &threadData[i]);
         }
+        while (i < iEnd) out[k++] = leftRun[i++];
+        while (j < jEnd) out[k++] = rightRun[j++];
+    }
+    
+    // Idle loop of workers 1..numThreads-1: steal until the root job is done
+    static void* workerThread(void* arg) {
+        Worker& w = *static_cast<Worker*>(arg);
+        ParallelSort& sorter = *w.owner;
+        long long start = getCurrentTimeMicros();
         
-        // Wait for all threads to complete
+        pthread_mutex_lock(&sorter.idleLock);
+        while (!sorter.finished) {
+            if (sorter.queued > 0) {
+                pthread_mutex_unlock(&sorter.idleLock);
+                Job* job = sorter.steal(w);
+                if (job) sorter.runStolen(w, job);
+                pthread_mutex_lock(&sorter.idleLock);
+            } else {
+                sorter.sleep(w);
+            }
+        }
+        pthread_mutex_unlock(&sorter.idleLock);
+        
+        w.busyTime = getCurrentTimeMicros() - start - w.idleTime;
+        return nullptr;
+    }
+    
+    // The calling thread is worker 0 and runs the root job; the others
+    // start idle and steal
+    template<typename Item, typename Less>
+    void sortItems(SortRun<Item, Less>& sortRun, int size) {
         for (int i = 0; i < numThreads; i++) {
-            pthread_join(threads[i], nullptr);
+            workers[i].top = 0;
+            workers[i].bottom = 0;
+            workers[i].busyTime = 0;
+            workers[i].idleTime = 0;
+            workers[i].jobsRun = 0;
+            workers[i].steals = 0;
+        }
+        if (size <= 1) return;
+        
+        if (numThreads == 1 || size <= SORT_CUTOFF) {
+            long long start = getCurrentTimeMicros();
+            pingPongSort(sortRun.array, sortRun.scratch, 0, size - 1, false, sortRun.less);
+            workers[0].busyTime = getCurrentTimeMicros() - start;
+            workers[0].jobsRun = 1;
+            return;
+        }
+        
+        queued = 0;
+        finished = false;
+        for (int i = 1; i < numThreads; i++) {
+            pending[i] = pool.submit(workerThread, &workers[i]);
         }
         
-        // FIXED: Correct sequential merging of sorted chunks
-        // After threads complete, we have numThreads sorted subarrays
-        // We need to merge them sequentially
+        long long start = getCurrentTimeMicros();
+        Job root = makeJob(sortRun, SORT_JOB, false, 0, 0, size - 1, 0, 0);
+        run(workers[0], root);
+        workers[0].busyTime = getCurrentTimeMicros() - start - workers[0].idleTime;
         
-        // Merge chunks one by one into the final sorted array
+        pthread_mutex_lock(&idleLock);
+        finished = true;
+        pthread_cond_broadcast(&idleCond);
+        pthread_mutex_unlock(&idleLock);
         for (int i = 1; i < numThreads; i++) {
-            // Calculate boundaries for merging
-            int leftStart = 0;
-            int leftEnd = threadData[i - 1].right;
-            int rightStart = threadData[i].left;
-            int rightEnd = threadData[i].right;
+            pending[i].get();
+        }
+    }
+    
+    enum KeyKind { NAME_KEYS, ROLL_KEYS };
+    
+    // One range of key extraction
+    struct KeyChunk {
+        KeyedStudent<RollNumType, CourseIDType>* entries;
+        StudentType** students;
+        int first;
+        int end;
+        KeyKind kind;
+    };
+    
+    // Keys for compareByName: the first 16 lowercased name bytes in key
+    // and tieKey. Names shorter than 16 bytes are equal when both words
+    // are, so only they carry the roll number key that breaks the tie.
+    // Students without a name sort last, as in compareByName.
+    static void* extractKeysThread(void* arg) {
+        KeyChunk* chunk = static_cast<KeyChunk*>(arg);
+        for (int i = chunk->first; i < chunk->end; i++) {
+            KeyedStudent<RollNumType, CourseIDType>& entry = chunk->entries[i];
+            StudentType* student = chunk->students[i];
+            entry.student = student;
+            
+            entry.tieKey = 0;
+            entry.rollKey = 0;
+            if (chunk->kind == ROLL_KEYS) {
+                entry.key = student->getRollKey();
+                continue;
+            }
+            const char* name = student->getName();
+            if (!name) {
+                entry.key = ~0ULL;
+                continue;
+            }
+            bool ended;
+            entry.key = packLowercase(name, ended);
+            if (!ended) entry.tieKey = packLowercase(name + 8, ended);
+            if (ended) entry.rollKey = student->getRollKey();
+        }
+        return nullptr;
+    }
+    
+    void sortByKey(StudentType** data, int size, KeyKind kind,
+                   bool (*cmp)(const StudentType&, const StudentType&)) {
+        const int MIN_CHUNK_STUDENTS = 16384;
+        if (size > keyCapacity) {
+            if (keyEntries) delete[] keyEntries;
+            if (keyScratch) delete[] keyScratch;
+            keyEntries = new KeyedStudent<RollNumType, CourseIDType>[size];
+            keyScratch = new KeyedStudent<RollNumType, CourseIDType>[size];
+            keyCapacity = size;
+        }
+        
+        // Extract keys in ranges on the pool; the first range runs here
+        KeyChunk chunks[MAX_KEY_CHUNKS];
+        int chunkCount = numThreads < MAX_KEY_CHUNKS ? numThreads : MAX_KEY_CHUNKS;
+        if (chunkCount > size / MIN_CHUNK_STUDENTS) chunkCount = size / MIN_CHUNK_STUDENTS;
+        if (chunkCount < 1) chunkCount = 1;
+        for (int c = 0; c < chunkCount; c++) {
+            chunks[c].entries = keyEntries;
+            chunks[c].students = data;
+            chunks[c].first = (int)((long long)size * c / chunkCount);
+            chunks[c].end = (int)((long long)size * (c + 1) / chunkCount);
+            chunks[c].kind = kind;
+            if (c > 0) pending[c] = pool.submit(extractKeysThread, &chunks[c]);
+        }
+        extractKeysThread(&chunks[0]);
+        for (int c = 1; c < chunkCount; c++) {
+            pending[c].get();
+        }
+        
+        SortRun<KeyedStudent<RollNumType, CourseIDType>, KeyedStudentLess<RollNumType, CourseIDType> > sortRun = {
+            keyEntries, keyScratch, KeyedStudentLess<RollNumType, CourseIDType>(cmp)
+        };
+        sortItems(sortRun, size);
+        
+        for (int i = 0; i < size; i++) {
+            data[i] = keyEntries[i].student;
+        }
+    }
+    
+    void printDuration(void (*outputFunc)(const char*), void (*outputIntFunc)(int),
+                       long long microSeconds) {
+        // Display time in the most appropriate unit
+        if (microSeconds < 1000) {
+            // Less than 1ms - show only microseconds
+            outputIntFunc((int)microSeconds);
+            outputFunc(" microseconds\n");
+        } else if (microSeconds < 1000000) {
+            // Less than 1 second - show milliseconds with precision
+            long long milliseconds = microSeconds / 1000;
+            int remaining_us = (int)(microSeconds % 1000);
+            
+            outputIntFunc((int)milliseconds);
+            outputFunc(".");
             
-            // Only merge if both chunks have elements
-            if (leftEnd >= leftStart && rightEnd >= rightStart) {
-                // Merge from leftStart to rightEnd, with mid at leftEnd
-                merge(array, leftStart, leftEnd, rightEnd, compare);
+            if (remaining_us < 10) {
+                outputFunc("00");
+            } else if (remaining_us < 100) {
+                outputFunc("0");
             }
+            outputIntFunc(remaining_us);
+            outputFunc(" ms\n");
+        } else {
+            // 1 second or more - show seconds with precision
+            int seconds = (int)(microSeconds / 1000000);
+            int remaining_ms = (int)((microSeconds % 1000000) / 1000);
+            
+            outputIntFunc(seconds);
+            outputFunc(".");
+            
+            if (remaining_ms < 10) {
+                outputFunc("00");
+            } else if (remaining_ms < 100) {
+                outputFunc("0");
+            }
+            outputIntFunc(remaining_ms);
+            outputFunc(" s\n");
+        }
+    }
+
+public:
+    // Sorts with `threads` workers running on the shared thread pool;
+    // threads <= 0 uses one worker per pool thread
+    ParallelSort(int threads = 0) : numThreads(threads), pool(ThreadPool::instance()),
+                                    pending(nullptr), workers(nullptr), queued(0), finished(false),
+                                    pointerScratch(nullptr), pointerCapacity(0),
+                                    keyEntries(nullptr), keyScratch(nullptr), keyCapacity(0) {
+        if (numThreads <= 0) numThreads = pool.getSize();
+        pending = new ThreadPool::Future[numThreads];
+        workers = new Worker[numThreads];
+        for (int i = 0; i < numThreads; i++) {
+            workers[i].owner = this;
+            workers[i].id = i;
+            workers[i].top = 0;
+            workers[i].bottom = 0;
+            workers[i].victim = (unsigned int)i + 1;
+            workers[i].busyTime = 0;
+            workers[i].idleTime = 0;
+            workers[i].jobsRun = 0;
+            workers[i].steals = 0;
+            pthread_mutex_init(&workers[i].lock, nullptr);
+        }
+        pthread_mutex_init(&idleLock, nullptr);
+        pthread_cond_init(&idleCond, nullptr);
+    }
+    
+    ~ParallelSort() {
+        for (int i = 0; i < numThreads; i++) {
+            pthread_mutex_destroy(&workers[i].lock);
+        }
+        pthread_cond_destroy(&idleCond);
+        pthread_mutex_destroy(&idleLock);
+        delete[] workers;
+        delete[] pending;
+        if (pointerScratch) delete[] pointerScratch;
+        if (keyEntries) delete[] keyEntries;
+        if (keyScratch) delete[] keyScratch;
+    }
+    
+    int getThreadCount() const { return numThreads; }
+    
+    // Sorts data like mergeSort(data, 0, size - 1, cmp)
+    void sort(StudentType** data, int size, bool (*cmp)(const StudentType&, const StudentType&)) {
+        if (size > pointerCapacity) {
+            if (pointerScratch) delete[] pointerScratch;
+            pointerScratch = new StudentType*[size];
+            pointerCapacity = size;
         }
+        SortRun<StudentType*, StudentPointerLess<RollNumType, CourseIDType> > sortRun = {
+            data, pointerScratch, StudentPointerLess<RollNumType, CourseIDType>(cmp)
+        };
+        sortItems(sortRun, size);
+    }
+    
+    // Same order as sort(data, size, StudentType::compareByName), but most
+    // comparisons are settled by each student's lowercased name prefix
+    // and roll number key without following the Student pointers
+    void sortByName(StudentType** data, int size) {
+        sortByKey(data, size, NAME_KEYS, StudentType::compareByName);
+    }
+    
+    // Same order as sort(data, size, StudentType::compareByRollNumber),
+    // comparing packed roll number keys where both students have one
+    void sortByRollNumber(StudentType** data, int size) {
+        sortByKey(data, size, ROLL_KEYS, StudentType::compareByRollNumber);
     }
     
-    // Improved time display logic
+    long long getBusyTime(int worker) const { return workers[worker].busyTime; }
+    int getSteals(int worker) const { return workers[worker].steals; }
+    int getJobsRun(int worker) const { return workers[worker].jobsRun; }
+    
+    // Per-worker jobs, steals and time spent working (not idle) in the last sort
     void printThreadTimes(void (*outputFunc)(const char*), void (*outputIntFunc)(int)) {
         for (int i = 0; i < numThreads; i++) {
-            long long microSeconds = threadData[i].timeElapsed;
-            
-            outputFunc("Thread ");
-            outputIntFunc(threadData[i].threadId);
-            outputFunc(" took ");
+            outputFunc("Worker ");
+            outputIntFunc(workers[i].id);
+            outputFunc(": ");
+            outputIntFunc(workers[i].jobsRun);
+            outputFunc(" jobs, ");
+            outputIntFunc(workers[i].steals);
+            outputFunc(" steals, busy ");
             
-            if (microSeconds == 0) {
-                outputFunc("0 microseconds (Empty Chunk)\n");
+            if (workers[i].jobsRun == 0) {
+                outputFunc("0 microseconds (Idle)\n");
                 continue;
             }
-            
-            // Display time in the most appropriate unit
-            if (microSeconds < 1000) {
-                // Less than 1ms - show only microseconds
-                outputIntFunc((int)microSeconds);
-                outputFunc(" microseconds\n");
-            } else if (microSeconds < 1000000) {
-                // Less than 1 second - show milliseconds with precision
-                long long milliseconds = microSeconds / 1000;
-                int remaining_us = (int)(microSeconds % 1000);
-                
-                outputIntFunc((int)milliseconds);
-                outputFunc(".");
-                
-                if (remaining_us < 10) {
-                    outputFunc("00");
-                } else if (remaining_us < 100) {
-                    outputFunc("0");
-                }
-                outputIntFunc(remaining_us);
-                outputFunc(" ms\n");
-            } else {
-                // 1 second or more - show seconds with precision
-                int seconds = (int)(microSeconds / 1000000);
-                int remaining_ms = (int)((microSeconds % 1000000) / 1000);
-                
-                outputIntFunc(seconds);
-                outputFunc(".");
-                
-                if (remaining_ms < 10) {
-                    outputFunc("00");
-                } else if (remaining_ms < 100) {
-                    outputFunc("0");
-                }
-                outputIntFunc(remaining_ms);
-                outputFunc(" s\n");
-            }
+            printDuration(outputFunc, outputIntFunc,
+                          workers[i].busyTime > 0 ? workers[i].busyTime : 1);
         }
     }
 };
 
-#endif
\ No newline at end of file
+#endif
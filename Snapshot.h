@@ -0,0 +1,366 @@
+// Snapshot.h
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "StringUtils.h"
+#include "Student.h"
+#include "StudentDatabase.h"
+#include "MappedFile.h"
+#include "BufferedWriter.h"
+
+// Binary columnar snapshot of a StudentDatabase. Loading maps the file and
+// points every string straight into it; nothing is parsed or copied.
+//
+// Layout (sections 8-byte aligned, native little-endian):
+//   SnapshotHeader
+//   rolls[studentCount]            8 bytes: heap offset or integer value
+//   years[studentCount]            int
+//   names[studentCount]            heap offset
+//   branches[studentCount]         heap offset
+//   currentStart[studentCount+1]   index into courses
+//   completedStart[studentCount+1] index into courses
+//   courses[courseCount]           SnapshotCourse (all current, then all completed)
+//   heap[heapSize]                 NUL-terminated strings, in column order
+// A heap offset of -1 encodes a null string.
+
+const unsigned int SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    unsigned int version;
+    unsigned int rollTag;
+    unsigned int courseIdTag;
+    unsigned int reserved;
+    long long studentCount;
+    long long courseCount;
+    long long rollsOffset;
+    long long yearsOffset;
+    long long namesOffset;
+    long long branchesOffset;
+    long long currentStartOffset;
+    long long completedStartOffset;
+    long long coursesOffset;
+    long long heapOffset;
+    long long heapSize;
+};
+
+struct SnapshotCourse {
+    long long courseId;
+    long long nameOffset;
+    int grade;
+    int reserved;
+};
+
+// How a roll number / course ID type is stored in an 8-byte column
+template<typename T>
+struct SnapshotColumn;
+
+template<>
+struct SnapshotColumn<const char*> {
+    static const unsigned int TAG = 1;
+
+    static long long encode(const char* value, long long& heapCursor) {
+        if (!value) return -1;
+        long long offset = heapCursor;
+        heapCursor += my_strlen(value) + 1;
+        return offset;
+    }
+
+    static void writeHeap(const char* value, BufferedWriter& out) {
+        if (value) out.write(value, my_strlen(value) + 1);
+    }
+
+    static const char* decode(long long word, const char* heap) {
+        return word < 0 ? nullptr : heap + word;
+    }
+
+    static bool valid(long long word, long long heapSize) {
+        return word >= -1 && word < heapSize;
+    }
+};
+
+template<>
+struct SnapshotColumn<int> {
+    static const unsigned int TAG = 2;
+    static long long encode(int value, long long&) { return value; }
+    static void writeHeap(int, BufferedWriter&) {}
+    static int decode(long long word, const char*) { return (int)word; }
+    static bool valid(long long, long long) { return true; }
+};
+
+template<>
+struct SnapshotColumn<unsigned int> {
+    static const unsigned int TAG = 3;
+    static long long encode(unsigned int value, long long&) { return value; }
+    static void writeHeap(unsigned int, BufferedWriter&) {}
+    static unsigned int decode(long long word, const char*) { return (unsigned int)word; }
+    static bool valid(long long, long long) { return true; }
+};
+
+class Snapshot {
+private:
+    static const char* magic() { return "STUDSNAP"; }
+
+    static long long align8(long long offset) {
+        return (offset + 7) & ~7LL;
+    }
+
+    static void pad(BufferedWriter& out, long long target) {
+        const char zeros[8] = {0};
+        while (out.getOffset() < target) {
+            long long gap = target - out.getOffset();
+            out.write(zeros, gap < 8 ? gap : 8);
+        }
+    }
+
+    // Section offsets follow from the two counts alone
+    static void computeLayout(SnapshotHeader& header) {
+        long long n = header.studentCount;
+        header.rollsOffset = align8(sizeof(SnapshotHeader));
+        header.yearsOffset = align8(header.rollsOffset + n * 8);
+        header.namesOffset = align8(header.yearsOffset + n * (long long)sizeof(int));
+        header.branchesOffset = align8(header.namesOffset + n * 8);
+        header.currentStartOffset = align8(header.branchesOffset + n * 8);
+        header.completedStartOffset = align8(header.currentStartOffset + (n + 1) * 8);
+        header.coursesOffset = align8(header.completedStartOffset + (n + 1) * 8);
+        header.heapOffset = align8(header.coursesOffset + header.courseCount * (long long)sizeof(SnapshotCourse));
+    }
+
+    template<typename CourseIDType>
+    static void writeCourse(const Course<CourseIDType>& course, long long& heapCursor, BufferedWriter& out) {
+        SnapshotCourse record;
+        record.courseId = SnapshotColumn<CourseIDType>::encode(course.getCourseId(), heapCursor);
+        record.nameOffset = SnapshotColumn<const char*>::encode(course.getCourseName(), heapCursor);
+        record.grade = course.getGrade();
+        record.reserved = 0;
+        out.write(&record, sizeof(record));
+    }
+
+    template<typename CourseIDType>
+    static void writeCourseHeap(const Course<CourseIDType>& course, BufferedWriter& out) {
+        SnapshotColumn<CourseIDType>::writeHeap(course.getCourseId(), out);
+        SnapshotColumn<const char*>::writeHeap(course.getCourseName(), out);
+    }
+
+public:
+    template<typename RollNumType, typename CourseIDType>
+    static bool save(const char* filename, const StudentDatabase<RollNumType, CourseIDType>& db) {
+        typedef SnapshotColumn<RollNumType> RollColumn;
+        typedef SnapshotColumn<const char*> StringColumn;
+
+        int n = db.getCount();
+        SnapshotHeader header;
+        for (int i = 0; i < 8; i++) header.magic[i] = magic()[i];
+        header.version = SNAPSHOT_VERSION;
+        header.rollTag = RollColumn::TAG;
+        header.courseIdTag = SnapshotColumn<CourseIDType>::TAG;
+        header.reserved = 0;
+        header.studentCount = n;
+        header.courseCount = 0;
+        for (int i = 0; i < n; i++) {
+            header.courseCount += db.getStudent(i).getCurrentCoursesCount();
+            header.courseCount += db.getStudent(i).getCompletedCoursesCount();
+        }
+        computeLayout(header);
+
+        // Heap size: a dry run of the encoders in column order
+        long long heapCursor = 0;
+        for (int i = 0; i < n; i++) RollColumn::encode(db.getStudent(i).getRollNumber(), heapCursor);
+        for (int i = 0; i < n; i++) StringColumn::encode(db.getStudent(i).getName(), heapCursor);
+        for (int i = 0; i < n; i++) StringColumn::encode(db.getStudent(i).getBranch(), heapCursor);
+        for (int i = 0; i < n; i++) {
+            const Student<RollNumType, CourseIDType>& s = db.getStudent(i);
+            for (int j = 0; j < s.getCurrentCoursesCount(); j++) {
+                SnapshotColumn<CourseIDType>::encode(s.getCurrentCourse(j).getCourseId(), heapCursor);
+                StringColumn::encode(s.getCurrentCourse(j).getCourseName(), heapCursor);
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            const Student<RollNumType, CourseIDType>& s = db.getStudent(i);
+            for (int j = 0; j < s.getCompletedCoursesCount(); j++) {
+                SnapshotColumn<CourseIDType>::encode(s.getCompletedCourse(j).getCourseId(), heapCursor);
+                StringColumn::encode(s.getCompletedCourse(j).getCourseName(), heapCursor);
+            }
+        }
+        header.heapSize = heapCursor;
+
+        BufferedWriter out;
+        if (!out.open(filename)) return false;
+        out.write(&header, sizeof(header));
+
+        // Columns, in the same order the heap offsets were assigned
+        heapCursor = 0;
+        pad(out, header.rollsOffset);
+        for (int i = 0; i < n; i++) {
+            long long word = RollColumn::encode(db.getStudent(i).getRollNumber(), heapCursor);
+            out.write(&word, 8);
+        }
+        pad(out, header.yearsOffset);
+        for (int i = 0; i < n; i++) {
+            int year = db.getStudent(i).getStartingYear();
+            out.write(&year, sizeof(year));
+        }
+        pad(out, header.namesOffset);
+        for (int i = 0; i < n; i++) {
+            long long word = StringColumn::encode(db.getStudent(i).getName(), heapCursor);
+            out.write(&word, 8);
+        }
+        pad(out, header.branchesOffset);
+        for (int i = 0; i < n; i++) {
+            long long word = StringColumn::encode(db.getStudent(i).getBranch(), heapCursor);
+            out.write(&word, 8);
+        }
+
+        pad(out, header.currentStartOffset);
+        long long start = 0;
+        for (int i = 0; i <= n; i++) {
+            out.write(&start, 8);
+            if (i < n) start += db.getStudent(i).getCurrentCoursesCount();
+        }
+        pad(out, header.completedStartOffset);
+        for (int i = 0; i <= n; i++) {
+            out.write(&start, 8);
+            if (i < n) start += db.getStudent(i).getCompletedCoursesCount();
+        }
+
+        pad(out, header.coursesOffset);
+        for (int i = 0; i < n; i++) {
+            const Student<RollNumType, CourseIDType>& s = db.getStudent(i);
+            for (int j = 0; j < s.getCurrentCoursesCount(); j++) {
+                writeCourse(s.getCurrentCourse(j), heapCursor, out);
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            const Student<RollNumType, CourseIDType>& s = db.getStudent(i);
+            for (int j = 0; j < s.getCompletedCoursesCount(); j++) {
+                writeCourse(s.getCompletedCourse(j), heapCursor, out);
+            }
+        }
+
+        pad(out, header.heapOffset);
+        for (int i = 0; i < n; i++) RollColumn::writeHeap(db.getStudent(i).getRollNumber(), out);
+        for (int i = 0; i < n; i++) StringColumn::writeHeap(db.getStudent(i).getName(), out);
+        for (int i = 0; i < n; i++) StringColumn::writeHeap(db.getStudent(i).getBranch(), out);
+        for (int i = 0; i < n; i++) {
+            const Student<RollNumType, CourseIDType>& s = db.getStudent(i);
+            for (int j = 0; j < s.getCurrentCoursesCount(); j++) writeCourseHeap(s.getCurrentCourse(j), out);
+        }
+        for (int i = 0; i < n; i++) {
+            const Student<RollNumType, CourseIDType>& s = db.getStudent(i);
+            for (int j = 0; j < s.getCompletedCoursesCount(); j++) writeCourseHeap(s.getCompletedCourse(j), out);
+        }
+
+        return out.close();
+    }
+
+    // Appends the snapshot's students to db, or replaces its contents when
+    // replace is set. The whole file is validated before db is touched, so
+    // a failed load leaves db as it was. The file stays mapped for the
+    // database's lifetime and all strings point into it.
+    template<typename RollNumType, typename CourseIDType>
+    static bool load(const char* filename, StudentDatabase<RollNumType, CourseIDType>& db,
+                     bool replace = false) {
+        typedef SnapshotColumn<RollNumType> RollColumn;
+        typedef SnapshotColumn<CourseIDType> CourseIdColumn;
+        typedef SnapshotColumn<const char*> StringColumn;
+
+        MappedFile* file = new MappedFile;
+        if (!file->open(filename) || file->getSize() < (long)sizeof(SnapshotHeader)) {
+            delete file;
+            return false;
+        }
+
+        const char* base = file->getData();
+        SnapshotHeader header = *(const SnapshotHeader*)base;
+
+        // Reject foreign, stale or truncated files before touching columns
+        SnapshotHeader expected = header;
+        bool ok = header.version == SNAPSHOT_VERSION &&
+                  header.rollTag == RollColumn::TAG &&
+                  header.courseIdTag == CourseIdColumn::TAG &&
+                  header.studentCount >= 0 && header.studentCount < 0x7fffffff &&
+                  header.courseCount >= 0 && header.courseCount < (1LL << 40) &&
+                  header.heapSize >= 0;
+        for (int i = 0; ok && i < 8; i++) ok = header.magic[i] == magic()[i];
+        if (ok) {
+            // Every section must sit where the counts put it, and the course
+            // records must end before the heap
+            computeLayout(expected);
+            ok = expected.rollsOffset == header.rollsOffset &&
+                 expected.yearsOffset == header.yearsOffset &&
+                 expected.namesOffset == header.namesOffset &&
+                 expected.branchesOffset == header.branchesOffset &&
+                 expected.currentStartOffset == header.currentStartOffset &&
+                 expected.completedStartOffset == header.completedStartOffset &&
+                 expected.coursesOffset == header.coursesOffset &&
+                 expected.heapOffset == header.heapOffset &&
+                 expected.coursesOffset + expected.courseCount * (long long)sizeof(SnapshotCourse) <=
+                     expected.heapOffset &&
+                 expected.heapOffset + header.heapSize == file->getSize() &&
+                 (header.heapSize == 0 || base[file->getSize() - 1] == '\0');
+        }
+        if (!ok) {
+            delete file;
+            return false;
+        }
+
+        int n = (int)header.studentCount;
+        const long long* rolls = (const long long*)(base + expected.rollsOffset);
+        const int* years = (const int*)(base + expected.yearsOffset);
+        const long long* names = (const long long*)(base + expected.namesOffset);
+        const long long* branches = (const long long*)(base + expected.branchesOffset);
+        const long long* currentStart = (const long long*)(base + expected.currentStartOffset);
+        const long long* completedStart = (const long long*)(base + expected.completedStartOffset);
+        const SnapshotCourse* courses = (const SnapshotCourse*)(base + expected.coursesOffset);
+        const char* heap = base + expected.heapOffset;
+        long long heapSize = header.heapSize;
+
+        for (int i = 0; ok && i < n; i++) {
+            ok = RollColumn::valid(rolls[i], heapSize) &&
+                 StringColumn::valid(names[i], heapSize) &&
+                 StringColumn::valid(branches[i], heapSize) &&
+                 currentStart[i] <= currentStart[i + 1] &&
+                 completedStart[i] <= completedStart[i + 1];
+        }
+        ok = ok && currentStart[0] == 0 && currentStart[n] == completedStart[0] &&
+             completedStart[n] == header.courseCount;
+        for (long long c = 0; ok && c < header.courseCount; c++) {
+            ok = CourseIdColumn::valid(courses[c].courseId, heapSize) &&
+                 StringColumn::valid(courses[c].nameOffset, heapSize);
+        }
+        if (!ok) {
+            delete file;
+            return false;
+        }
+
+        if (replace) db.clear();
+        db.reserve(db.getCount() + n);
+        for (int i = 0; i < n; i++) {
+            Student<RollNumType, CourseIDType> student(
+                StringColumn::decode(names[i], heap),
+                RollColumn::decode(rolls[i], heap),
+                StringColumn::decode(branches[i], heap),
+                years[i], BORROW_STRINGS);
+
+            for (long long c = currentStart[i]; c < currentStart[i + 1]; c++) {
+                student.addCurrentCourse(Course<CourseIDType>(
+                    CourseIdColumn::decode(courses[c].courseId, heap),
+                    StringColumn::decode(courses[c].nameOffset, heap),
+                    courses[c].grade, BORROW_STRINGS));
+            }
+            for (long long c = completedStart[i]; c < completedStart[i + 1]; c++) {
+                student.addCompletedCourse(Course<CourseIDType>(
+                    CourseIdColumn::decode(courses[c].courseId, heap),
+                    StringColumn::decode(courses[c].nameOffset, heap),
+                    courses[c].grade, BORROW_STRINGS));
+            }
+
+            db.addStudent(std::move(student));
+        }
+
+        db.adoptMapping(file);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,104 @@
+// StringInterner.cpp
+#include "StringInterner.h"
+
+static const int INITIAL_SLOTS = 64;
+
+// FNV-1a
+static unsigned int hashString(const char* str, int length) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool sameText(const char* a, const char* b, int length) {
+    for (int i = 0; i < length; i++) {
+        if (a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+StringInterner::StringInterner() : slots(nullptr), slotCount(0), used(0), parent(nullptr) {
+    pthread_mutex_init(&lock, nullptr);
+}
+
+StringInterner::~StringInterner() {
+    clear();
+    pthread_mutex_destroy(&lock);
+}
+
+void StringInterner::clear() {
+    if (slots) delete[] slots;
+    slots = nullptr;
+    slotCount = 0;
+    used = 0;
+    strings.clear();
+}
+
+void StringInterner::share(StringInterner& parentInterner) {
+    parent = &parentInterner;
+}
+
+void StringInterner::moveStorageTo(Arena& arena) {
+    arena.absorb(strings);
+    if (slots) delete[] slots;
+    slots = nullptr;
+    slotCount = 0;
+    used = 0;
+}
+
+void StringInterner::grow() {
+    int newCount = slotCount == 0 ? INITIAL_SLOTS : slotCount * 2;
+    Slot* newSlots = new Slot[newCount];
+    for (int i = 0; i < newCount; i++) {
+        newSlots[i].str = nullptr;
+    }
+    for (int i = 0; i < slotCount; i++) {
+        if (!slots[i].str) continue;
+        int pos = slots[i].hash & (newCount - 1);
+        while (newSlots[pos].str) pos = (pos + 1) & (newCount - 1);
+        newSlots[pos] = slots[i];
+    }
+    if (slots) delete[] slots;
+    slots = newSlots;
+    slotCount = newCount;
+}
+
+// Adds (str, length) to the table, pointing at canonical if given or at
+// a fresh copy in our own arena otherwise
+const char* StringInterner::insert(const char* str, int length, unsigned int hash,
+                                   const char* canonical) {
+    if ((used + 1) * 2 > slotCount) grow();
+    int pos = hash & (slotCount - 1);
+    while (slots[pos].str) pos = (pos + 1) & (slotCount - 1);
+    slots[pos].str = canonical ? canonical : strings.store(str, length);
+    slots[pos].length = length;
+    slots[pos].hash = hash;
+    used++;
+    return slots[pos].str;
+}
+
+const char* StringInterner::intern(const char* str, int length) {
+    unsigned int hash = hashString(str, length);
+    if (slotCount > 0) {
+        int pos = hash & (slotCount - 1);
+        while (slots[pos].str) {
+            if (slots[pos].hash == hash && slots[pos].length == length &&
+                sameText(slots[pos].str, str, length)) {
+                return slots[pos].str;
+            }
+            pos = (pos + 1) & (slotCount - 1);
+        }
+    }
+    const char* canonical = parent ? parent->internShared(str, length) : nullptr;
+    return insert(str, length, hash, canonical);
+}
+
+const char* StringInterner::internShared(const char* str, int length) {
+    pthread_mutex_lock(&lock);
+    const char* canonical = intern(str, length);
+    pthread_mutex_unlock(&lock);
+    return canonical;
+}
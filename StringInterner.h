@@ -0,0 +1,60 @@
+// StringInterner.h
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include "Arena.h"
+#include <pthread.h>
+
+// Hash table that keeps one canonical copy of each distinct string, so
+// repeated values (branches, course IDs, course names) share storage and
+// two interned strings are equal exactly when their pointers are.
+//
+// A loader thread can share() a parent interner: lookups hit the thread's
+// own table first and only a miss takes the parent's lock, so every thread
+// ends up with the parent's canonical pointers.
+class StringInterner {
+private:
+    struct Slot {
+        const char* str;
+        int length;
+        unsigned int hash;
+    };
+
+    Slot* slots;
+    int slotCount;      // power of two
+    int used;
+    Arena strings;      // interned text, unless a parent owns it
+    StringInterner* parent;
+    pthread_mutex_t lock;
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    void grow();
+    const char* insert(const char* str, int length, unsigned int hash, const char* canonical);
+    const char* internShared(const char* str, int length);
+
+public:
+    StringInterner();
+    ~StringInterner();
+
+    // Canonical copy of str[0..length); equal inputs give the same pointer
+    const char* intern(const char* str, int length);
+
+    // Same as intern(); lets an interner stand in for an Arena
+    const char* store(const char* str, int length) { return intern(str, length); }
+
+    // Resolve misses through parent (thread-safe) from now on
+    void share(StringInterner& parentInterner);
+
+    // Moves the text this interner owns into arena, so pointers already
+    // handed out outlive the interner, and empties the table
+    void moveStorageTo(Arena& arena);
+
+    // Forgets every string; pointers handed out become invalid
+    void clear();
+
+    int getCount() const { return used; }
+};
+
+#endif
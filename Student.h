@@ -3,50 +3,130 @@
 #define STUDENT_H
 
 #include "StringUtils.h"
+#include <new>
+#include <type_traits>
+#include <utility>
 
-// Course template
+// How a Course/Student holds its strings: COPY_STRINGS owns private heap
+// copies; BORROW_STRINGS points at storage that outlives the object (a
+// database's arena or mapped snapshot). Copies of a borrowing
+// object borrow the same storage, like const char* roll numbers do.
+enum StringOwnership {
+    COPY_STRINGS,
+    BORROW_STRINGS
+};
+
+// Packs a roll number into a 64-bit key whose order matches my_strcmp, so
+// sorting and hashing need not touch the string. The top nibble is the
+// program (1 = all digits as in "2021001", 2 = "MT", 3 = "PhD"); the
+// digits after the prefix (year, then serial) follow one nibble each as
+// digit + 1, zero padded. Rolls of any other shape, or with more than 15
+// digits, give 0 and are compared as strings.
+inline unsigned long long encodeRollNumber(const char* roll) {
+    if (!roll) return 0;
+    unsigned long long key;
+    const char* digits;
+    if (roll[0] >= '0' && roll[0] <= '9') {
+        key = 1;
+        digits = roll;
+    } else if (roll[0] == 'M' && roll[1] == 'T') {
+        key = 2;
+        digits = roll + 2;
+    } else if (roll[0] == 'P' && roll[1] == 'h' && roll[2] == 'D') {
+        key = 3;
+        digits = roll + 3;
+    } else {
+        return 0;
+    }
+    
+    int count = 0;
+    for (; digits[count]; count++) {
+        if (count == 15 || digits[count] < '0' || digits[count] > '9') return 0;
+        key = (key << 4) | (unsigned long long)(digits[count] - '0' + 1);
+    }
+    if (count == 0) return 0;
+    return key << (4 * (15 - count));
+}
+
+// Integral roll numbers are their own key. Signed values have the sign
+// bit flipped so negative rolls order before non-negative ones; the one
+// value that maps to 0 simply falls back to the comparator. Other types
+// have no key.
+template<typename T>
+inline unsigned long long encodeRollNumber(const T& roll) {
+    if constexpr (std::is_integral<T>::value) {
+        if constexpr (std::is_signed<T>::value) {
+            return (unsigned long long)(long long)roll ^ (1ULL << 63);
+        } else {
+            return (unsigned long long)roll;
+        }
+    } else {
+        return 0;
+    }
+}
+
+// Course template. Fields are ordered widest first so the object packs
+// tightly: 16 bytes for integral IDs, 24 for string IDs.
 template<typename CourseIDType>
 class Course {
 private:
+    const char* courseName;
     CourseIDType courseId;
-    char* courseName;
-    int grade;
+    short grade;
+    bool ownsName;
+
+    static const char* duplicate(const char* str) {
+        char* copy = nullptr;
+        if (str) copyString(copy, str);
+        return copy;
+    }
 
 public:
-    Course() : courseId(), courseName(nullptr), grade(-1) {}
+    Course() : courseName(nullptr), courseId(), grade(-1), ownsName(true) {}
     
     Course(CourseIDType id, const char* name, int gr) 
-        : courseId(id), courseName(nullptr), grade(gr) {
-        if (name) {
-            courseName = new char[my_strlen(name) + 1];
-            my_strcpy(courseName, name);
-        }
+        : courseName(duplicate(name)), courseId(id), grade((short)gr), ownsName(true) {}
+    
+    Course(CourseIDType id, const char* name, int gr, StringOwnership ownership)
+        : courseName(ownership == BORROW_STRINGS ? name : duplicate(name)), courseId(id),
+          grade((short)gr), ownsName(ownership == COPY_STRINGS) {}
+    
+    Course(const Course& other)
+        : courseName(other.ownsName ? duplicate(other.courseName) : other.courseName),
+          courseId(other.courseId), grade(other.grade), ownsName(other.ownsName) {}
+    
+    // Moves take over the name; other is left without one
+    Course(Course&& other) noexcept
+        : courseName(other.courseName), courseId(other.courseId),
+          grade(other.grade), ownsName(other.ownsName) {
+        other.courseName = nullptr;
     }
     
-    Course(const Course& other) : courseId(other.courseId), courseName(nullptr), grade(other.grade) {
-        if (other.courseName) {
-            courseName = new char[my_strlen(other.courseName) + 1];
-            my_strcpy(courseName, other.courseName);
+    Course& operator=(const Course& other) {
+        if (this != &other) {
+            if (ownsName && courseName) delete[] courseName;
+            courseId = other.courseId;
+            grade = other.grade;
+            ownsName = other.ownsName;
+            courseName = other.ownsName ? duplicate(other.courseName) : other.courseName;
         }
+        return *this;
     }
     
-    Course& operator=(const Course& other) {
+    Course& operator=(Course&& other) noexcept {
         if (this != &other) {
-            if (courseName) delete[] courseName;
+            if (ownsName && courseName) delete[] courseName;
             courseId = other.courseId;
             grade = other.grade;
-            if (other.courseName) {
-                courseName = new char[my_strlen(other.courseName) + 1];
-                my_strcpy(courseName, other.courseName);
-            } else {
-                courseName = nullptr;
-            }
+            ownsName = other.ownsName;
+            courseName = other.courseName;
+            other.courseName = nullptr;
         }
         return *this;
     }
     
     ~Course() {
-        if (courseName) delete[] courseName;
+        if (ownsName && courseName) delete[] courseName;
     }
     
     CourseIDType getCourseId() const { return courseId; }
@@ -54,138 +134,246 @@ public:
     int getGrade() const { return grade; }
 };
 
+// Course list that stores its first INLINE courses inside the owning
+// object and only moves to the heap when it grows past them, so a typical
+// student's courses sit next to the rest of its record.
+template<typename CourseIDType, int INLINE>
+class CourseList {
+private:
+    Course<CourseIDType> inlineCourses[INLINE];
+    Course<CourseIDType>* heapCourses;   // null while the inline slots suffice
+    int count;
+    int capacity;
+
+    Course<CourseIDType>* items() { return heapCourses ? heapCourses : inlineCourses; }
+    const Course<CourseIDType>* items() const { return heapCourses ? heapCourses : inlineCourses; }
+
+    // Makes room for one more course, moving the existing ones
+    void grow() {
+        if (count < capacity) return;
+        int newCapacity = capacity * 2;
+        Course<CourseIDType>* newArray = new Course<CourseIDType>[newCapacity];
+        Course<CourseIDType>* old = items();
+        for (int i = 0; i < count; i++) {
+            newArray[i] = std::move(old[i]);
+        }
+        if (heapCourses) delete[] heapCourses;
+        heapCourses = newArray;
+        capacity = newCapacity;
+    }
+
+    void copyFrom(const CourseList& other) {
+        if (other.count > INLINE) {
+            heapCourses = new Course<CourseIDType>[other.count];
+            capacity = other.count;
+        }
+        Course<CourseIDType>* dest = items();
+        const Course<CourseIDType>* src = other.items();
+        for (int i = 0; i < other.count; i++) {
+            dest[i] = src[i];
+        }
+        count = other.count;
+    }
+
+    // Heap storage is taken over; inline courses are moved one by one
+    void moveFrom(CourseList& other) {
+        if (other.heapCourses) {
+            heapCourses = other.heapCourses;
+            capacity = other.capacity;
+            other.heapCourses = nullptr;
+            other.capacity = INLINE;
+        } else {
+            for (int i = 0; i < other.count; i++) {
+                inlineCourses[i] = std::move(other.inlineCourses[i]);
+            }
+        }
+        count = other.count;
+        other.count = 0;
+    }
+
+    void release() {
+        if (heapCourses) delete[] heapCourses;
+        heapCourses = nullptr;
+        Course<CourseIDType> empty;
+        for (int i = 0; i < count && i < INLINE; i++) {
+            inlineCourses[i] = empty;
+        }
+        count = 0;
+        capacity = INLINE;
+    }
+
+public:
+    CourseList() : heapCourses(nullptr), count(0), capacity(INLINE) {}
+    
+    CourseList(const CourseList& other) : heapCourses(nullptr), count(0), capacity(INLINE) {
+        copyFrom(other);
+    }
+    
+    CourseList(CourseList&& other) noexcept : heapCourses(nullptr), count(0), capacity(INLINE) {
+        moveFrom(other);
+    }
+    
+    CourseList& operator=(const CourseList& other) {
+        if (this != &other) {
+            release();
+            copyFrom(other);
+        }
+        return *this;
+    }
+    
+    CourseList& operator=(CourseList&& other) noexcept {
+        if (this != &other) {
+            release();
+            moveFrom(other);
+        }
+        return *this;
+    }
+    
+    ~CourseList() {
+        if (heapCourses) delete[] heapCourses;
+    }
+    
+    void add(const Course<CourseIDType>& course) {
+        grow();
+        items()[count++] = course;
+    }
+    
+    void add(Course<CourseIDType>&& course) {
+        grow();
+        items()[count++] = std::move(course);
+    }
+    
+    // Constructs the course in its slot from Course constructor arguments;
+    // the slot's empty default course is destroyed first
+    template<typename... Args>
+    Course<CourseIDType>& emplace(Args&&... args) {
+        grow();
+        Course<CourseIDType>* slot = items() + count;
+        slot->~Course<CourseIDType>();
+        new (slot) Course<CourseIDType>(std::forward<Args>(args)...);
+        count++;
+        return *slot;
+    }
+    
+    int size() const { return count; }
+    const Course<CourseIDType>& operator[](int index) const { return items()[index]; }
+};
+
 // Student template
 template<typename RollNumType, typename CourseIDType>
 class Student {
+public:
+    // Courses kept inside the record before spilling to the heap; most
+    // students have one current and two completed courses
+    static const int INLINE_CURRENT_COURSES = 1;
+    static const int INLINE_COMPLETED_COURSES = 2;
+
 private:
-    char* name;
+    const char* name;
     RollNumType rollNumber;
-    char* branch;
+    unsigned long long rollKey;   // encodeRollNumber(rollNumber), computed once
+    const char* branch;
     int startingYear;
     int insertionOrder;
+    bool ownsStrings;   // name and branch; see StringOwnership
+    
+    CourseList<CourseIDType, INLINE_CURRENT_COURSES> currentCourses;
+    CourseList<CourseIDType, INLINE_COMPLETED_COURSES> completedCourses;
+
+    static const char* duplicate(const char* str) {
+        char* copy = nullptr;
+        if (str) copyString(copy, str);
+        return copy;
+    }
     
-    Course<CourseIDType>* currentCourses;
-    int currentCoursesCount;
-    int currentCoursesCapacity;
+    void releaseStrings() {
+        if (ownsStrings) {
+            if (name) delete[] name;
+            if (branch) delete[] branch;
+        }
+    }
     
-    Course<CourseIDType>* completedCourses;
-    int completedCoursesCount;
-    int completedCoursesCapacity;
+    // Takes other's strings, leaving it without any
+    void stealStrings(Student& other) {
+        name = other.name;
+        branch = other.branch;
+        ownsStrings = other.ownsStrings;
+        other.name = nullptr;
+        other.branch = nullptr;
+    }
 
 public:
-    Student() : name(nullptr), rollNumber(), branch(nullptr), startingYear(0), insertionOrder(0),
-                currentCourses(nullptr), currentCoursesCount(0), currentCoursesCapacity(0),
-                completedCourses(nullptr), completedCoursesCount(0), completedCoursesCapacity(0) {}
+    Student() : name(nullptr), rollNumber(), rollKey(0), branch(nullptr), startingYear(0), insertionOrder(0),
+                ownsStrings(true) {}
     
     Student(const char* n, RollNumType roll, const char* br, int year)
-        : name(nullptr), rollNumber(roll), branch(nullptr), startingYear(year), insertionOrder(0),
-          currentCourses(nullptr), currentCoursesCount(0), currentCoursesCapacity(0),
-          completedCourses(nullptr), completedCoursesCount(0), completedCoursesCapacity(0) {
-        if (n) {
-            name = new char[my_strlen(n) + 1];
-            my_strcpy(name, n);
-        }
-        if (br) {
-            branch = new char[my_strlen(br) + 1];
-            my_strcpy(branch, br);
-        }
-    }
+        : name(duplicate(n)), rollNumber(roll), rollKey(encodeRollNumber(roll)), branch(duplicate(br)),
+          startingYear(year), insertionOrder(0),
+          ownsStrings(true) {}
+    
+    Student(const char* n, RollNumType roll, const char* br, int year, StringOwnership ownership)
+        : name(ownership == BORROW_STRINGS ? n : duplicate(n)), rollNumber(roll),
+          rollKey(encodeRollNumber(roll)),
+          branch(ownership == BORROW_STRINGS ? br : duplicate(br)),
+          startingYear(year), insertionOrder(0), ownsStrings(ownership == COPY_STRINGS) {}
     
     Student(const Student& other)
-        : name(nullptr), rollNumber(other.rollNumber), branch(nullptr), 
+        : name(other.ownsStrings ? duplicate(other.name) : other.name),
+          rollNumber(other.rollNumber), rollKey(other.rollKey),
+          branch(other.ownsStrings ? duplicate(other.branch) : other.branch), 
           startingYear(other.startingYear), insertionOrder(other.insertionOrder),
-          currentCourses(nullptr), currentCoursesCount(0), currentCoursesCapacity(0),
-          completedCourses(nullptr), completedCoursesCount(0), completedCoursesCapacity(0) {
-        if (other.name) {
-            name = new char[my_strlen(other.name) + 1];
-            my_strcpy(name, other.name);
-        }
-        if (other.branch) {
-            branch = new char[my_strlen(other.branch) + 1];
-            my_strcpy(branch, other.branch);
-        }
-        
-        if (other.currentCoursesCount > 0) {
-            currentCoursesCapacity = other.currentCoursesCount;
-            currentCourses = new Course<CourseIDType>[currentCoursesCapacity];
-            for (int i = 0; i < other.currentCoursesCount; i++) {
-                currentCourses[i] = other.currentCourses[i];
-            }
-            currentCoursesCount = other.currentCoursesCount;
-        }
-        
-        if (other.completedCoursesCount > 0) {
-            completedCoursesCapacity = other.completedCoursesCount;
-            completedCourses = new Course<CourseIDType>[completedCoursesCapacity];
-            for (int i = 0; i < other.completedCoursesCount; i++) {
-                completedCourses[i] = other.completedCourses[i];
-            }
-            completedCoursesCount = other.completedCoursesCount;
+          ownsStrings(other.ownsStrings),
+          currentCourses(other.currentCourses), completedCourses(other.completedCourses) {}
+    
+    Student(Student&& other) noexcept
+        : name(nullptr), rollNumber(other.rollNumber), rollKey(other.rollKey), branch(nullptr),
+          startingYear(other.startingYear), insertionOrder(other.insertionOrder), ownsStrings(true),
+          currentCourses(std::move(other.currentCourses)),
+          completedCourses(std::move(other.completedCourses)) {
+        stealStrings(other);
+    }
+    
+    Student& operator=(Student&& other) noexcept {
+        if (this != &other) {
+            releaseStrings();
+            stealStrings(other);
+            rollNumber = other.rollNumber;
+            rollKey = other.rollKey;
+            startingYear = other.startingYear;
+            insertionOrder = other.insertionOrder;
+            currentCourses = std::move(other.currentCourses);
+            completedCourses = std::move(other.completedCourses);
         }
+        return *this;
     }
     
     Student& operator=(const Student& other) {
         if (this != &other) {
-            if (name) delete[] name;
-            if (branch) delete[] branch;
-            if (currentCourses) delete[] currentCourses;
-            if (completedCourses) delete[] completedCourses;
+            releaseStrings();
             
             rollNumber = other.rollNumber;
+            rollKey = other.rollKey;
             startingYear = other.startingYear;
             insertionOrder = other.insertionOrder;
             
-            if (other.name) {
-                name = new char[my_strlen(other.name) + 1];
-                my_strcpy(name, other.name);
-            } else {
-                name = nullptr;
-            }
-            
-            if (other.branch) {
-                branch = new char[my_strlen(other.branch) + 1];
-                my_strcpy(branch, other.branch);
-            } else {
-                branch = nullptr;
-            }
-            
-            currentCoursesCount = 0;
-            currentCoursesCapacity = 0;
-            currentCourses = nullptr;
-            if (other.currentCoursesCount > 0) {
-                currentCoursesCapacity = other.currentCoursesCount;
-                currentCourses = new Course<CourseIDType>[currentCoursesCapacity];
-                for (int i = 0; i < other.currentCoursesCount; i++) {
-                    currentCourses[i] = other.currentCourses[i];
-                }
-                currentCoursesCount = other.currentCoursesCount;
-            }
+            ownsStrings = other.ownsStrings;
+            name = ownsStrings ? duplicate(other.name) : other.name;
+            branch = ownsStrings ? duplicate(other.branch) : other.branch;
             
-            completedCoursesCount = 0;
-            completedCoursesCapacity = 0;
-            completedCourses = nullptr;
-            if (other.completedCoursesCount > 0) {
-                completedCoursesCapacity = other.completedCoursesCount;
-                completedCourses = new Course<CourseIDType>[completedCoursesCapacity];
-                for (int i = 0; i < other.completedCoursesCount; i++) {
-                    completedCourses[i] = other.completedCourses[i];
-                }
-                completedCoursesCount = other.completedCoursesCount;
-            }
+            currentCourses = other.currentCourses;
+            completedCourses = other.completedCourses;
         }
         return *this;
     }
     
     ~Student() {
-        if (name) delete[] name;
-        if (branch) delete[] branch;
-        if (currentCourses) delete[] currentCourses;
-        if (completedCourses) delete[] completedCourses;
+        releaseStrings();
     }
     
     // Getters
     const char* getName() const { return name; }
     RollNumType getRollNumber() const { return rollNumber; }
+    unsigned long long getRollKey() const { return rollKey; }
     const char* getBranch() const { return branch; }
     int getStartingYear() const { return startingYear; }
     int getInsertionOrder() const { return insertionOrder; }
@@ -194,35 +382,34 @@ public:
     
     // Course management
     void addCurrentCourse(const Course<CourseIDType>& course) {
-        if (currentCoursesCount >= currentCoursesCapacity) {
-            int newCapacity = currentCoursesCapacity == 0 ? 4 : currentCoursesCapacity * 2;
-            Course<CourseIDType>* newArray = new Course<CourseIDType>[newCapacity];
-            for (int i = 0; i < currentCoursesCount; i++) {
-                newArray[i] = currentCourses[i];
-            }
-            if (currentCourses) delete[] currentCourses;
-            currentCourses = newArray;
-            currentCoursesCapacity = newCapacity;
-        }
-        currentCourses[currentCoursesCount++] = course;
+        currentCourses.add(course);
+    }
+    
+    void addCurrentCourse(Course<CourseIDType>&& course) {
+        currentCourses.add(std::move(course));
     }
     
     void addCompletedCourse(const Course<CourseIDType>& course) {
-        if (completedCoursesCount >= completedCoursesCapacity) {
-            int newCapacity = completedCoursesCapacity == 0 ? 4 : completedCoursesCapacity * 2;
-            Course<CourseIDType>* newArray = new Course<CourseIDType>[newCapacity];
-            for (int i = 0; i < completedCoursesCount; i++) {
-                newArray[i] = completedCourses[i];
-            }
-            if (completedCourses) delete[] completedCourses;
-            completedCourses = newArray;
-            completedCoursesCapacity = newCapacity;
-        }
-        completedCourses[completedCoursesCount++] = course;
+        completedCourses.add(course);
+    }
+    
+    void addCompletedCourse(Course<CourseIDType>&& course) {
+        completedCourses.add(std::move(course));
+    }
+    
+    // Construct from Course constructor arguments directly in the list
+    template<typename... Args>
+    Course<CourseIDType>& emplaceCurrentCourse(Args&&... args) {
+        return currentCourses.emplace(std::forward<Args>(args)...);
+    }
+    
+    template<typename... Args>
+    Course<CourseIDType>& emplaceCompletedCourse(Args&&... args) {
+        return completedCourses.emplace(std::forward<Args>(args)...);
     }
     
-    int getCurrentCoursesCount() const { return currentCoursesCount; }
-    int getCompletedCoursesCount() const { return completedCoursesCount; }
+    int getCurrentCoursesCount() const { return currentCourses.size(); }
+    int getCompletedCoursesCount() const { return completedCourses.size(); }
     
     const Course<CourseIDType>& getCurrentCourse(int index) const {
         return currentCourses[index];
@@ -234,7 +421,7 @@ public:
     
     // FIXED: Comparison functions
     static bool compareByRollNumber(const Student& a, const Student& b) {
-        return compareRollNumbers(a.rollNumber, b.rollNumber);
+        return compareRollNumbers(a.rollNumber, a.rollKey, b.rollNumber, b.rollKey);
     }
     
     static bool compareByName(const Student& a, const Student& b) {
@@ -247,19 +434,22 @@ public:
                 return cmp < 0;
             }
             // If names are equal, compare by roll number
-            return compareRollNumbers(a.rollNumber, b.rollNumber);
+            return compareRollNumbers(a.rollNumber, a.rollKey, b.rollNumber, b.rollKey);
         }
         return a.name != nullptr;
     }
 private:
     // Helper function to compare roll numbers (handles both string and int types)
     template<typename T>
-    static bool compareRollNumbers(const T& a, const T& b) {
+    static bool compareRollNumbers(const T& a, unsigned long long, const T& b, unsigned long long) {
         return a < b;  // Default: use operator<
     }
     
-    // Specialization for const char* (string comparison)
-    static bool compareRollNumbers(const char* const& a, const char* const& b) {
+    // Specialization for const char*: packed keys when both rolls have
+    // one, string comparison otherwise
+    static bool compareRollNumbers(const char* const& a, unsigned long long keyA,
+                                   const char* const& b, unsigned long long keyB) {
+        if (keyA && keyB) return keyA < keyB;
         return my_strcmp(a, b) < 0;
     }
 };
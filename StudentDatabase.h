@@ -3,186 +3,824 @@
 #define STUDENT_DATABASE_H
 
 #include "Student.h"
+#include "Arena.h"
+#include "StringInterner.h"
+#include "MappedFile.h"
+#include "ParallelSort.h"
+#include "ThreadPool.h"
 
-// Helper function for comparing course IDs (from CSVReader.h)
+// Helper function for comparing course IDs
 template<typename CourseIDType>
-inline bool courseIdsEqual(const CourseIDType& a, const CourseIDType& b);
+inline bool courseIdsEqual(const CourseIDType& a, const CourseIDType& b) {
+    return a == b;
+}
 
-// Simple hash table for quick student lookup by course and grade
-template<typename RollNumType, typename CourseIDType>
+// String course codes compare case-insensitively. Loaded codes are
+// interned, so equal codes usually share a pointer and skip the compare.
+template<>
+inline bool courseIdsEqual<const char*>(const char* const& a, const char* const& b) {
+    return a == b || my_stricmp(a, b) == 0;
+}
+
+// Spreads a 64-bit integer over 32 hash bits (murmur3 finalizer)
+inline unsigned int hashInteger(unsigned long long key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return (unsigned int)key;
+}
+
+// Hash consistent with courseIdsEqual
+template<typename CourseIDType>
+inline unsigned int courseIdHash(const CourseIDType& id) {
+    return hashInteger((unsigned long long)id);
+}
+
+// FNV-1a over the lower-cased code, so "dsa" and "DSA" share a bucket
+template<>
+inline unsigned int courseIdHash<const char*>(const char* const& id) {
+    unsigned int hash = 2166136261u;
+    if (id) {
+        for (const char* c = id; *c; c++) {
+            char lower = (*c >= 'A' && *c <= 'Z') ? (char)(*c + ('a' - 'A')) : *c;
+            hash ^= (unsigned char)lower;
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+// Grade index: a hash table keyed by course ID, holding one posting list
+// per grade for each course. A minimum grade or a grade range is answered
+// by concatenating the lists of the grades it covers, best grade first;
+// within a grade, entries keep the order they were added in. Building is
+// linear in the number of completed courses.
+// Entries are student pointers by default; a StudentTable indexes row IDs.
+template<typename RollNumType, typename CourseIDType,
+         typename EntryRef = Student<RollNumType, CourseIDType>*>
 class CourseGradeIndex {
+public:
+    // Completed-course grades outside 0..MAX_GRADE are not indexed
+    static const int MAX_GRADE = 10;
+
 private:
-    struct IndexEntry {
-        CourseIDType courseId;
-        int minGrade;
-        Student<RollNumType, CourseIDType>** students;
+    struct PostingList {
+        EntryRef* items;
         int count;
         int capacity;
         
-        IndexEntry() : students(nullptr), count(0), capacity(0) {}
-        
-        ~IndexEntry() {
-            if (students) delete[] students;
-        }
-        
-        void addStudent(Student<RollNumType, CourseIDType>* student) {
+        void add(EntryRef item) {
             if (count >= capacity) {
                 int newCapacity = capacity == 0 ? 4 : capacity * 2;
-                Student<RollNumType, CourseIDType>** newArray = 
-                    new Student<RollNumType, CourseIDType>*[newCapacity];
+                EntryRef* newArray = new EntryRef[newCapacity];
                 for (int i = 0; i < count; ++i) {
-                    newArray[i] = students[i];
+                    newArray[i] = items[i];
                 }
-                if (students) delete[] students;
-                students = newArray;
+                if (items) delete[] items;
+                items = newArray;
                 capacity = newCapacity;
             }
-            students[count++] = student;
+            items[count++] = item;
         }
+        
+        // Appends other's items after this list's own
+        void append(const PostingList& other) {
+            if (other.count == 0) return;
+            if (count + other.count > capacity) {
+                int newCapacity = count + other.count;
+                EntryRef* newArray = new EntryRef[newCapacity];
+                for (int i = 0; i < count; ++i) {
+                    newArray[i] = items[i];
+                }
+                if (items) delete[] items;
+                items = newArray;
+                capacity = newCapacity;
+            }
+            for (int i = 0; i < other.count; ++i) {
+                items[count++] = other.items[i];
+            }
+        }
+    };
+    
+    // Plain data: posting arrays are freed by clear(), so entries can be
+    // copied bitwise when the entry array grows
+    struct CourseEntry {
+        CourseIDType courseId;
+        unsigned int hash;
+        PostingList grades[MAX_GRADE + 1];
     };
     
-    IndexEntry* entries;
+    CourseEntry* entries;   // in order of first appearance
     int entriesCount;
     int entriesCapacity;
+    
+    int* slots;             // open addressing: index into entries, -1 = empty
+    int slotCount;          // power of two
+    
+    EntryRef* results;      // concatenation buffer for multi-grade queries
+    int resultsCapacity;
+    
+    CourseGradeIndex(const CourseGradeIndex&) = delete;
+    CourseGradeIndex& operator=(const CourseGradeIndex&) = delete;
+    
+    void rehash(int newSlotCount) {
+        if (slots) delete[] slots;
+        slots = new int[newSlotCount];
+        slotCount = newSlotCount;
+        for (int i = 0; i < slotCount; ++i) {
+            slots[i] = -1;
+        }
+        int mask = slotCount - 1;
+        for (int e = 0; e < entriesCount; ++e) {
+            int i = (int)(entries[e].hash & mask);
+            while (slots[i] != -1) i = (i + 1) & mask;
+            slots[i] = e;
+        }
+    }
+    
+    int findEntry(const CourseIDType& courseId, unsigned int hash) const {
+        if (entriesCount == 0) return -1;
+        int mask = slotCount - 1;
+        for (int i = (int)(hash & mask); slots[i] != -1; i = (i + 1) & mask) {
+            const CourseEntry& entry = entries[slots[i]];
+            if (entry.hash == hash && courseIdsEqual(entry.courseId, courseId)) return slots[i];
+        }
+        return -1;
+    }
+    
+    int findOrAddEntry(const CourseIDType& courseId) {
+        unsigned int hash = courseIdHash(courseId);
+        int found = findEntry(courseId, hash);
+        if (found != -1) return found;
+        
+        if (entriesCount >= entriesCapacity) {
+            int newCapacity = entriesCapacity == 0 ? 16 : entriesCapacity * 2;
+            CourseEntry* newArray = new CourseEntry[newCapacity];
+            for (int i = 0; i < entriesCount; ++i) {
+                newArray[i] = entries[i];
+            }
+            if (entries) delete[] entries;
+            entries = newArray;
+            entriesCapacity = newCapacity;
+        }
+        CourseEntry& entry = entries[entriesCount];
+        entry.courseId = courseId;
+        entry.hash = hash;
+        for (int g = 0; g <= MAX_GRADE; ++g) {
+            entry.grades[g].items = nullptr;
+            entry.grades[g].count = 0;
+            entry.grades[g].capacity = 0;
+        }
+        entriesCount++;
+        
+        if (entriesCount * 2 > slotCount) {
+            rehash(slotCount == 0 ? 32 : slotCount * 2);
+        } else {
+            int mask = slotCount - 1;
+            int i = (int)(hash & mask);
+            while (slots[i] != -1) i = (i + 1) & mask;
+            slots[i] = entriesCount - 1;
+        }
+        return entriesCount - 1;
+    }
 
 public:
-    CourseGradeIndex() : entries(nullptr), entriesCount(0), entriesCapacity(0) {}
+    CourseGradeIndex() : entries(nullptr), entriesCount(0), entriesCapacity(0),
+                         slots(nullptr), slotCount(0), results(nullptr), resultsCapacity(0) {}
     
     ~CourseGradeIndex() {
-        if (entries) delete[] entries;
+        clear();
     }
     
-    void buildIndex(Student<RollNumType, CourseIDType>* students, int count) {
-        // Clear existing index
+    void clear() {
+        for (int e = 0; e < entriesCount; ++e) {
+            for (int g = 0; g <= MAX_GRADE; ++g) {
+                if (entries[e].grades[g].items) delete[] entries[e].grades[g].items;
+            }
+        }
         if (entries) delete[] entries;
+        if (slots) delete[] slots;
+        if (results) delete[] results;
         entries = nullptr;
         entriesCount = 0;
         entriesCapacity = 0;
-        
-        // Build new index
-        for (int i = 0; i < count; ++i) {
-            int completedCount = students[i].getCompletedCoursesCount();
-            for (int j = 0; j < completedCount; ++j) {
-                const auto& course = students[i].getCompletedCourse(j);
-                int grade = course.getGrade();
-                if (grade >= 9) { // Only index high-performing students
-                    addToIndex(course.getCourseId(), 9, &students[i]);
-                }
+        slots = nullptr;
+        slotCount = 0;
+        results = nullptr;
+        resultsCapacity = 0;
+    }
+    
+    // Indexes every completed course of one student
+    void indexStudent(Student<RollNumType, CourseIDType>* student) {
+        int completedCount = student->getCompletedCoursesCount();
+        for (int j = 0; j < completedCount; ++j) {
+            const auto& course = student->getCompletedCourse(j);
+            addToIndex(course.getCourseId(), course.getGrade(), student);
+        }
+    }
+    
+    void addToIndex(const CourseIDType& courseId, int grade, EntryRef student) {
+        if (grade < 0 || grade > MAX_GRADE) return;
+        int e = findOrAddEntry(courseId);   // may reallocate entries
+        entries[e].grades[grade].add(student);
+    }
+    
+    // Appends every list of other after this index's own, so indexes built
+    // over consecutive ranges merge into the one a serial build produces
+    void absorb(const CourseGradeIndex& other) {
+        for (int oe = 0; oe < other.entriesCount; ++oe) {
+            const CourseEntry& source = other.entries[oe];
+            int e = findOrAddEntry(source.courseId);
+            for (int g = 0; g <= MAX_GRADE; ++g) {
+                entries[e].grades[g].append(source.grades[g]);
             }
         }
     }
     
-    void addToIndex(const CourseIDType& courseId, int minGrade, 
-                    Student<RollNumType, CourseIDType>* student) {
-        // Find existing entry or create new one
-        int entryIndex = -1;
-        for (int i = 0; i < entriesCount; ++i) {
-            // Use courseIdsEqual for proper comparison
-            if (courseIdsEqual(entries[i].courseId, courseId) && entries[i].minGrade == minGrade) {
-                entryIndex = i;
-                break;
+    // Drops one occurrence of student from the course's list for grade,
+    // keeping the order of the rest; for updates and deletes
+    void removeFromIndex(const CourseIDType& courseId, int grade, EntryRef student) {
+        if (grade < 0 || grade > MAX_GRADE) return;
+        int e = findEntry(courseId, courseIdHash(courseId));
+        if (e == -1) return;
+        PostingList& list = entries[e].grades[grade];
+        for (int i = 0; i < list.count; ++i) {
+            if (list.items[i] == student) {
+                for (int j = i + 1; j < list.count; ++j) {
+                    list.items[j - 1] = list.items[j];
+                }
+                list.count--;
+                return;
             }
         }
+    }
+    
+    void unindexStudent(Student<RollNumType, CourseIDType>* student) {
+        int completedCount = student->getCompletedCoursesCount();
+        for (int j = 0; j < completedCount; ++j) {
+            const auto& course = student->getCompletedCourse(j);
+            removeFromIndex(course.getCourseId(), course.getGrade(), student);
+        }
+    }
+    
+    // Entries with minGrade <= grade <= maxGrade in the course. results
+    // points into the index and stays valid until the next query or update.
+    void queryRange(const CourseIDType& courseId, int minGrade, int maxGrade,
+                    EntryRef*& resultsOut, int& resultCount) {
+        resultsOut = nullptr;
+        resultCount = 0;
+        if (minGrade < 0) minGrade = 0;
+        if (maxGrade > MAX_GRADE) maxGrade = MAX_GRADE;
         
-        if (entryIndex == -1) {
-            // Create new entry
-            if (entriesCount >= entriesCapacity) {
-                int newCapacity = entriesCapacity == 0 ? 8 : entriesCapacity * 2;
-                IndexEntry* newArray = new IndexEntry[newCapacity];
-                // Manually copy old entries to avoid double-free on array destruction
-                for (int i = 0; i < entriesCount; ++i) {
-                    newArray[i].courseId = entries[i].courseId;
-                    newArray[i].minGrade = entries[i].minGrade;
-                    newArray[i].students = entries[i].students;
-                    newArray[i].count = entries[i].count;
-                    newArray[i].capacity = entries[i].capacity;
-                    // Reset old entry so its destructor doesn't free the dynamically allocated student array
-                    entries[i].students = nullptr;
-                    entries[i].count = 0;
-                    entries[i].capacity = 0;
-                }
-                if (entries) delete[] entries;
-                entries = newArray;
-                entriesCapacity = newCapacity;
+        int e = findEntry(courseId, courseIdHash(courseId));
+        if (e == -1 || minGrade > maxGrade) return;
+        PostingList* grades = entries[e].grades;
+        
+        int total = 0;
+        int nonEmpty = 0;
+        for (int g = maxGrade; g >= minGrade; --g) {
+            total += grades[g].count;
+            if (grades[g].count > 0) {
+                nonEmpty++;
+                resultsOut = grades[g].items;
             }
-            entryIndex = entriesCount++;
-            entries[entryIndex].courseId = courseId;
-            entries[entryIndex].minGrade = minGrade;
         }
+        resultCount = total;
+        if (nonEmpty <= 1) return;   // a single list is returned in place
         
-        entries[entryIndex].addStudent(student);
+        if (total > resultsCapacity) {
+            if (results) delete[] results;
+            resultsCapacity = total;
+            results = new EntryRef[resultsCapacity];
+        }
+        int pos = 0;
+        for (int g = maxGrade; g >= minGrade; --g) {
+            for (int i = 0; i < grades[g].count; ++i) {
+                results[pos++] = grades[g].items[i];
+            }
+        }
+        resultsOut = results;
     }
     
     void query(const CourseIDType& courseId, int minGrade,
-               Student<RollNumType, CourseIDType>**& results, int& resultCount) {
-        results = nullptr;
-        resultCount = 0;
+               EntryRef*& resultsOut, int& resultCount) {
+        queryRange(courseId, minGrade, MAX_GRADE, resultsOut, resultCount);
+    }
+};
+
+// How RollIndex keys a roll number. Integral rolls are their own key;
+// string rolls use the packed key from encodeRollNumber, which the
+// Student stores at load, and fall back to hashing and comparing the
+// text when they have none.
+template<typename T>
+struct RollLookup {
+    static unsigned long long key(const T& roll) { return (unsigned long long)roll; }
+    static unsigned long long key(const T& roll, unsigned long long) { return (unsigned long long)roll; }
+    static bool exact(unsigned long long) { return true; }
+    static unsigned int hashText(const T&) { return 0; }
+    static bool equal(const T& a, const T& b) { return a == b; }
+};
+
+template<>
+struct RollLookup<const char*> {
+    static unsigned long long key(const char* roll) { return encodeRollNumber(roll); }
+    static unsigned long long key(const char*, unsigned long long storedKey) { return storedKey; }
+    static bool exact(unsigned long long key) { return key != 0; }
+    static unsigned int hashText(const char* roll) {
+        unsigned int hash = 2166136261u;   // FNV-1a
+        if (roll) {
+            for (; *roll; roll++) {
+                hash ^= (unsigned char)*roll;
+                hash *= 16777619u;
+            }
+        }
+        return hash;
+    }
+    static bool equal(const char* a, const char* b) {
+        return a == b || (a && b && my_strcmp(a, b) == 0);
+    }
+};
+
+// Open-addressing (linear probing) hash index from roll number to student.
+// Each slot keeps the key and hash next to the student pointer, so a probe
+// only dereferences the student for string rolls without a packed key.
+// If several students share a roll, the first one added is found.
+template<typename RollNumType, typename CourseIDType>
+class RollIndex {
+private:
+    struct Slot {
+        Student<RollNumType, CourseIDType>* student;   // nullptr = empty
+        unsigned long long key;
+        unsigned int hash;
+    };
+    
+    Slot* slots;
+    int slotCount;   // power of two
+    int used;
+    
+    RollIndex(const RollIndex&) = delete;
+    RollIndex& operator=(const RollIndex&) = delete;
+    
+    static unsigned int hashRoll(const RollNumType& roll, unsigned long long key) {
+        if (!RollLookup<RollNumType>::exact(key)) return RollLookup<RollNumType>::hashText(roll);
+        return hashInteger(key);
+    }
+    
+    bool matches(const Slot& slot, const RollNumType& roll, unsigned long long key,
+                 unsigned int hash) const {
+        if (slot.hash != hash) return false;
+        bool exactKey = RollLookup<RollNumType>::exact(key);
+        if (exactKey != RollLookup<RollNumType>::exact(slot.key)) return false;
+        if (exactKey) return slot.key == key;
+        return RollLookup<RollNumType>::equal(slot.student->getRollNumber(), roll);
+    }
+    
+    Student<RollNumType, CourseIDType>* probe(const RollNumType& roll, unsigned long long key,
+                                              unsigned int hash) const {
+        if (used == 0) return nullptr;
+        int mask = slotCount - 1;
+        for (int i = (int)(hash & mask); slots[i].student; i = (i + 1) & mask) {
+            if (matches(slots[i], roll, key, hash)) return slots[i].student;
+        }
+        return nullptr;
+    }
+    
+    void rehash(int newSlotCount) {
+        Slot* old = slots;
+        int oldCount = slotCount;
+        slots = new Slot[newSlotCount];
+        slotCount = newSlotCount;
+        for (int i = 0; i < slotCount; ++i) {
+            slots[i].student = nullptr;
+        }
+        int mask = slotCount - 1;
+        for (int i = 0; i < oldCount; ++i) {
+            if (!old[i].student) continue;
+            int j = (int)(old[i].hash & mask);
+            while (slots[j].student) j = (j + 1) & mask;
+            slots[j] = old[i];
+        }
+        if (old) delete[] old;
+    }
+
+public:
+    // Keys looked up together by findAll(); their slots are prefetched
+    // before any of them is probed
+    static const int LOOKUP_BATCH = 16;
+    
+    RollIndex() : slots(nullptr), slotCount(0), used(0) {}
+    
+    ~RollIndex() {
+        if (slots) delete[] slots;
+    }
+    
+    void clear() {
+        if (slots) delete[] slots;
+        slots = nullptr;
+        slotCount = 0;
+        used = 0;
+    }
+    
+    // Sizes the table for count students without further rehashing
+    void reserve(int count) {
+        int needed = 16;
+        while (needed < count * 2) needed *= 2;
+        if (needed > slotCount) rehash(needed);
+    }
+    
+    // Adds student unless a student with the same roll is already indexed.
+    // The student must not move while indexed.
+    void insert(Student<RollNumType, CourseIDType>* student) {
+        if ((used + 1) * 2 > slotCount) rehash(slotCount == 0 ? 16 : slotCount * 2);
         
-        for (int i = 0; i < entriesCount; ++i) {
-            // Use courseIdsEqual for proper comparison
-            if (courseIdsEqual(entries[i].courseId, courseId) && entries[i].minGrade == minGrade) {
-                results = entries[i].students;
-                resultCount = entries[i].count;
-                return;
+        RollNumType roll = student->getRollNumber();
+        unsigned long long key = RollLookup<RollNumType>::key(roll, student->getRollKey());
+        unsigned int hash = hashRoll(roll, key);
+        int mask = slotCount - 1;
+        int i = (int)(hash & mask);
+        for (; slots[i].student; i = (i + 1) & mask) {
+            if (matches(slots[i], roll, key, hash)) return;
+        }
+        slots[i].student = student;
+        slots[i].key = key;
+        slots[i].hash = hash;
+        used++;
+    }
+    
+    Student<RollNumType, CourseIDType>* find(const RollNumType& roll) const {
+        unsigned long long key = RollLookup<RollNumType>::key(roll);
+        return probe(roll, key, hashRoll(roll, key));
+    }
+    
+    // results[i] = find(rolls[i]). Keys are hashed a batch at a time and
+    // their first slots prefetched, so the cache misses of a batch overlap
+    // instead of being taken one after another.
+    void findAll(const RollNumType* rolls, int rollCount,
+                 const Student<RollNumType, CourseIDType>** results) const {
+        unsigned long long keys[LOOKUP_BATCH];
+        unsigned int hashes[LOOKUP_BATCH];
+        int mask = slotCount - 1;
+        for (int first = 0; first < rollCount; first += LOOKUP_BATCH) {
+            int n = rollCount - first < LOOKUP_BATCH ? rollCount - first : LOOKUP_BATCH;
+            for (int i = 0; i < n; ++i) {
+                keys[i] = RollLookup<RollNumType>::key(rolls[first + i]);
+                hashes[i] = hashRoll(rolls[first + i], keys[i]);
+                if (used > 0) __builtin_prefetch(&slots[hashes[i] & mask]);
+            }
+            for (int i = 0; i < n; ++i) {
+                results[first + i] = probe(rolls[first + i], keys[i], hashes[i]);
             }
         }
     }
+    
+    int getCount() const { return used; }
 };
 
-// Database class to manage students
+// Growable batch of students built by one loader thread.
+// Batches are spliced into a StudentDatabase in file order.
 template<typename RollNumType, typename CourseIDType>
-class StudentDatabase {
+class StudentBatch {
 private:
     Student<RollNumType, CourseIDType>* students;
     int count;
     int capacity;
+    Arena arena;       // sub-arena of the loader thread that fills this batch
+    StringInterner interner;
+
+    StudentBatch(const StudentBatch&) = delete;
+    StudentBatch& operator=(const StudentBatch&) = delete;
+
+    void grow() {
+        int newCapacity = capacity == 0 ? 64 : capacity * 2;
+        Student<RollNumType, CourseIDType>* newArray = 
+            new Student<RollNumType, CourseIDType>[newCapacity];
+        for (int i = 0; i < count; ++i) {
+            newArray[i] = std::move(students[i]);
+        }
+        if (students) delete[] students;
+        students = newArray;
+        capacity = newCapacity;
+    }
+
+public:
+    StudentBatch() : students(nullptr), count(0), capacity(0) {}
+    
+    ~StudentBatch() {
+        if (students) delete[] students;
+    }
+    
+    void addStudent(const Student<RollNumType, CourseIDType>& student) {
+        if (count >= capacity) grow();
+        students[count++] = student;
+    }
+    
+    void addStudent(Student<RollNumType, CourseIDType>&& student) {
+        if (count >= capacity) grow();
+        students[count++] = std::move(student);
+    }
+    
+    int getCount() const { return count; }
+    
+    const Student<RollNumType, CourseIDType>& getStudent(int index) const {
+        return students[index];
+    }
+    
+    Student<RollNumType, CourseIDType>& getStudent(int index) {
+        return students[index];
+    }
+    
+    Arena& getArena() { return arena; }
+    StringInterner& getInterner() { return interner; }
+};
+
+// Database class to manage students
+template<typename RollNumType, typename CourseIDType>
+class StudentDatabase {
+public:
+    // Students live in fixed-size segments that never move once allocated,
+    // so views and the grade index stay valid as students are appended
+    static const int SEGMENT_SHIFT = 10;
+    static const int SEGMENT_SIZE = 1 << SEGMENT_SHIFT;
+
+private:
+    Student<RollNumType, CourseIDType>** segments;
+    int segmentCount;
+    int segmentCapacity;
+    int count;
+    int capacity;   // segmentCount * SEGMENT_SIZE
     
     Student<RollNumType, CourseIDType>** insertionOrder;
     Student<RollNumType, CourseIDType>** sortedOrder;
     Student<RollNumType, CourseIDType>** sortedOrderByName; // NEW: for sorting by name
     
+    // Kept current by addStudent and addCompletedCourse. Dirty once a
+    // student may have been changed behind its back (through a mutable
+    // reference) until buildGradeIndex() rebuilds it.
     CourseGradeIndex<RollNumType, CourseIDType> gradeIndex;
+    bool gradeIndexDirty;
+    
+    // Every student by roll number, kept current by addStudent
+    RollIndex<RollNumType, CourseIDType> rollIndex;
+    
+    // Strings of loaded students (names, const char* roll numbers); freed
+    // chunk by chunk together with the database
+    Arena arena;
+    
+    // Canonical branches, course IDs and course names of loaded students
+    StringInterner interner;
+    
+    // Snapshot files whose pages loaded students point into
+    MappedFile** mappings;
+    int mappingsCount;
 
+    Student<RollNumType, CourseIDType>& at(int index) {
+        return segments[index >> SEGMENT_SHIFT][index & (SEGMENT_SIZE - 1)];
+    }
+    
+    const Student<RollNumType, CourseIDType>& at(int index) const {
+        return segments[index >> SEGMENT_SHIFT][index & (SEGMENT_SIZE - 1)];
+    }
+    
     void expand() {
-        int newCapacity = capacity == 0 ? 100 : capacity * 2;
-        Student<RollNumType, CourseIDType>* newArray = 
-            new Student<RollNumType, CourseIDType>[newCapacity];
-        
-        for (int i = 0; i < count; ++i) {
-            newArray[i] = students[i];
+        reserve(capacity + SEGMENT_SIZE);
+    }
+    
+    // One range of a parallel grade index build
+    struct IndexRange {
+        StudentDatabase* db;
+        int first;
+        int end;
+        CourseGradeIndex<RollNumType, CourseIDType> partial;
+    };
+    
+    static void* indexRangeThread(void* arg) {
+        IndexRange* range = static_cast<IndexRange*>(arg);
+        for (int i = range->first; i < range->end; ++i) {
+            range->partial.indexStudent(&range->db->at(i));
         }
-        
-        if (students) delete[] students;
-        students = newArray;
-        capacity = newCapacity;
+        return nullptr;
+    }
+    
+    // Grows view from oldCount to count entries: the new students are sorted
+    // among themselves and merged in, so an already sorted view stays sorted
+    // and existing entries keep their relative order
+    void mergeIntoView(Student<RollNumType, CourseIDType>**& view, int oldCount,
+                       bool (*compare)(const Student<RollNumType, CourseIDType>&,
+                                       const Student<RollNumType, CourseIDType>&)) {
+        Student<RollNumType, CourseIDType>** grown = new Student<RollNumType, CourseIDType>*[count];
+        Student<RollNumType, CourseIDType>** scratch = new Student<RollNumType, CourseIDType>*[count];
+        for (int i = 0; i < oldCount; ++i) {
+            grown[i] = view[i];
+        }
+        for (int i = oldCount; i < count; ++i) {
+            grown[i] = &at(i);
+        }
+        mergeSort(grown, scratch, oldCount, count - 1, compare);
+        if (oldCount > 0 && oldCount < count) {
+            mergeRuns(grown, scratch, 0, oldCount - 1, count - 1,
+                      StudentPointerLess<RollNumType, CourseIDType>(compare));
+            Student<RollNumType, CourseIDType>** merged = scratch;
+            scratch = grown;
+            grown = merged;
+        }
+        delete[] scratch;
+        if (view) delete[] view;
+        view = grown;
     }
 
 public:
-    StudentDatabase() : students(nullptr), count(0), capacity(0),
-                       insertionOrder(nullptr), sortedOrder(nullptr), sortedOrderByName(nullptr) {} // UPDATED
+    StudentDatabase() : segments(nullptr), segmentCount(0), segmentCapacity(0), count(0), capacity(0),
+                       insertionOrder(nullptr), sortedOrder(nullptr), sortedOrderByName(nullptr), // UPDATED
+                       gradeIndexDirty(false), mappings(nullptr), mappingsCount(0) {}
     
     ~StudentDatabase() {
-        if (students) delete[] students;
+        clear();
+    }
+    
+    // Drops every student along with the views, index and backing storage
+    void clear() {
+        for (int i = 0; i < segmentCount; ++i) {
+            delete[] segments[i];
+        }
+        if (segments) delete[] segments;
         if (insertionOrder) delete[] insertionOrder;
         if (sortedOrder) delete[] sortedOrder;
         if (sortedOrderByName) delete[] sortedOrderByName; // UPDATED
+        segments = nullptr;
+        segmentCount = 0;
+        segmentCapacity = 0;
+        insertionOrder = nullptr;
+        sortedOrder = nullptr;
+        sortedOrderByName = nullptr;
+        count = 0;
+        capacity = 0;
+        gradeIndex.clear();
+        gradeIndexDirty = false;
+        rollIndex.clear();
+        
+        arena.clear();
+        interner.clear();
+        for (int i = 0; i < mappingsCount; ++i) {
+            delete mappings[i];
+        }
+        if (mappings) delete[] mappings;
+        mappings = nullptr;
+        mappingsCount = 0;
+    }
+    
+    // Keeps file mapped for the database's lifetime; students may borrow
+    // strings from its pages
+    void adoptMapping(MappedFile* file) {
+        MappedFile** grown = new MappedFile*[mappingsCount + 1];
+        for (int i = 0; i < mappingsCount; ++i) {
+            grown[i] = mappings[i];
+        }
+        grown[mappingsCount++] = file;
+        if (mappings) delete[] mappings;
+        mappings = grown;
+    }
+    
+    // Adds segments until at least newCapacity students fit. Existing
+    // students are never copied or moved; only the segment table grows.
+    void reserve(int newCapacity) {
+        while (capacity < newCapacity) {
+            if (segmentCount >= segmentCapacity) {
+                int newSegmentCapacity = segmentCapacity == 0 ? 4 : segmentCapacity * 2;
+                Student<RollNumType, CourseIDType>** grown = 
+                    new Student<RollNumType, CourseIDType>*[newSegmentCapacity];
+                for (int i = 0; i < segmentCount; ++i) {
+                    grown[i] = segments[i];
+                }
+                if (segments) delete[] segments;
+                segments = grown;
+                segmentCapacity = newSegmentCapacity;
+            }
+            segments[segmentCount++] = new Student<RollNumType, CourseIDType>[SEGMENT_SIZE];
+            capacity += SEGMENT_SIZE;
+        }
+        rollIndex.reserve(newCapacity);
     }
     
     void addStudent(const Student<RollNumType, CourseIDType>& student) {
         if (count >= capacity) {
             expand();
         }
-        students[count] = student;
-        students[count].setInsertionOrder(count);
+        at(count) = student;
+        at(count).setInsertionOrder(count);
+        rollIndex.insert(&at(count));
+        gradeIndex.indexStudent(&at(count));
         count++;
     }
     
+    void addStudent(Student<RollNumType, CourseIDType>&& student) {
+        if (count >= capacity) {
+            expand();
+        }
+        at(count) = std::move(student);
+        at(count).setInsertionOrder(count);
+        rollIndex.insert(&at(count));
+        gradeIndex.indexStudent(&at(count));
+        count++;
+    }
+    
+    // Constructs the student in its storage slot from Student constructor
+    // arguments and indexes it. Returns its index; add courses through
+    // addCompletedCourse()/emplaceCompletedCourse() so the grade index
+    // stays current.
+    template<typename... Args>
+    int emplaceStudent(Args&&... args) {
+        if (count >= capacity) {
+            expand();
+        }
+        Student<RollNumType, CourseIDType>* slot = &at(count);
+        slot->~Student<RollNumType, CourseIDType>();
+        new (slot) Student<RollNumType, CourseIDType>(std::forward<Args>(args)...);
+        slot->setInsertionOrder(count);
+        rollIndex.insert(slot);
+        gradeIndex.indexStudent(slot);
+        return count++;
+    }
+    
+    // Adds a completed course to student index and indexes it
+    void addCompletedCourse(int index, const Course<CourseIDType>& course) {
+        at(index).addCompletedCourse(course);
+        gradeIndex.addToIndex(course.getCourseId(), course.getGrade(), &at(index));
+    }
+    
+    void addCompletedCourse(int index, Course<CourseIDType>&& course) {
+        CourseIDType courseId = course.getCourseId();
+        int grade = course.getGrade();
+        at(index).addCompletedCourse(std::move(course));
+        gradeIndex.addToIndex(courseId, grade, &at(index));
+    }
+    
+    template<typename... Args>
+    void emplaceCompletedCourse(int index, Args&&... args) {
+        const Course<CourseIDType>& course =
+            at(index).emplaceCompletedCourse(std::forward<Args>(args)...);
+        gradeIndex.addToIndex(course.getCourseId(), course.getGrade(), &at(index));
+    }
+    
+    // Current courses are not in the grade index
+    template<typename... Args>
+    void emplaceCurrentCourse(int index, Args&&... args) {
+        at(index).emplaceCurrentCourse(std::forward<Args>(args)...);
+    }
+    
+    // Appends a loader batch, preserving its order. The batch's students
+    // and string storage move into the database, leaving the batch's
+    // records empty (a batch that shares our interner owns no interned
+    // text of its own).
+    void appendBatch(StudentBatch<RollNumType, CourseIDType>& batch) {
+        reserve(count + batch.getCount());
+        for (int i = 0; i < batch.getCount(); ++i) {
+            addStudent(std::move(batch.getStudent(i)));
+        }
+        arena.absorb(batch.getArena());
+        batch.getInterner().moveStorageTo(arena);
+    }
+    
+    // Appends newly arrived students and brings the order views up to date
+    // without re-sorting them (addStudent indexes their grades). Returns the
+    // number added.
+    int appendIncremental(StudentBatch<RollNumType, CourseIDType>& batch) {
+        int oldCount = count;
+        appendBatch(batch);
+        if (count == oldCount) return 0;
+        
+        if (insertionOrder) {
+            Student<RollNumType, CourseIDType>** grown = new Student<RollNumType, CourseIDType>*[count];
+            for (int i = 0; i < oldCount; ++i) {
+                grown[i] = insertionOrder[i];
+            }
+            for (int i = oldCount; i < count; ++i) {
+                grown[i] = &at(i);
+            }
+            delete[] insertionOrder;
+            insertionOrder = grown;
+            
+            mergeIntoView(sortedOrder, oldCount, compareByRollNumber);
+            mergeIntoView(sortedOrderByName, oldCount, compareByName);
+        }
+        
+        return count - oldCount;
+    }
+    
+    Arena& getArena() { return arena; }
+    StringInterner& getInterner() { return interner; }
+    
     int getCount() const { return count; }
     
-    Student<RollNumType, CourseIDType>* getStudents() { return students; }
+    // Mutable access; marks the grade index dirty
+    Student<RollNumType, CourseIDType>& getStudent(int index) {
+        gradeIndexDirty = true;
+        return at(index);
+    }
     
     const Student<RollNumType, CourseIDType>& getStudent(int index) const {
-        return students[index];
+        return at(index);
     }
     
     void prepareOrderViews() {
@@ -195,23 +833,35 @@ public:
         sortedOrderByName = new Student<RollNumType, CourseIDType>*[count]; // UPDATED
         
         for (int i = 0; i < count; ++i) {
-            insertionOrder[i] = &students[i];
-            sortedOrder[i] = &students[i];
-            sortedOrderByName[i] = &students[i]; // UPDATED
+            insertionOrder[i] = &at(i);
+            sortedOrder[i] = &at(i);
+            sortedOrderByName[i] = &at(i); // UPDATED
         }
     }
     
-    Student<RollNumType, CourseIDType>** getInsertionOrder() {
+    // The order views are read-only; students are changed through
+    // getStudent(int) or addCompletedCourse() so the grade index is kept
+    // current or marked dirty
+    const Student<RollNumType, CourseIDType>* const* getInsertionOrder() const {
         return insertionOrder;
     }
     
-    Student<RollNumType, CourseIDType>** getSortedOrder() {
+    const Student<RollNumType, CourseIDType>* const* getSortedOrder() const {
         return sortedOrder;
     }
     
-    Student<RollNumType, CourseIDType>** getSortedOrderByName() {
+    const Student<RollNumType, CourseIDType>* const* getSortedOrderByName() const {
         return sortedOrderByName;
     }
+    
+    // Re-sorts the roll number and name views in place with sorter
+    void sortByRollNumber(ParallelSort<RollNumType, CourseIDType>& sorter) {
+        sorter.sortByRollNumber(sortedOrder, count);
+    }
+    
+    void sortByName(ParallelSort<RollNumType, CourseIDType>& sorter) {
+        sorter.sortByName(sortedOrderByName, count);
+    }
 
     // NEW: Comparison function for Roll Number
     static bool compareByRollNumber(const Student<RollNumType, CourseIDType>& a, 
@@ -227,13 +877,72 @@ public:
         return Student<RollNumType, CourseIDType>::compareByName(a, b);
     }
     
+    // Student with the given roll number, or nullptr. To change it, pass
+    // its getInsertionOrder() to getStudent(int).
+    const Student<RollNumType, CourseIDType>* findByRoll(const RollNumType& roll) const {
+        return rollIndex.find(roll);
+    }
+    
+    // Looks up rollCount roll numbers at once (results[i] for rolls[i], nullptr
+    // when absent); faster than repeated findByRoll for large batches
+    void findByRolls(const RollNumType* rolls, int rollCount,
+                     const Student<RollNumType, CourseIDType>** results) const {
+        rollIndex.findAll(rolls, rollCount, results);
+    }
+    
+    // Full rebuild; only needed when the index is dirty. Large databases
+    // are indexed in ranges on the shared thread pool and the partial
+    // indexes absorbed in range order, which keeps every list in insertion
+    // order as in a serial build.
     void buildGradeIndex() {
-        gradeIndex.buildIndex(students, count);
+        const int MIN_RANGE_STUDENTS = 8192;
+        gradeIndex.clear();
+        
+        ThreadPool& pool = ThreadPool::instance();
+        int ranges = pool.getSize();
+        if (ranges > count / MIN_RANGE_STUDENTS) ranges = count / MIN_RANGE_STUDENTS;
+        if (ranges <= 1) {
+            for (int i = 0; i < count; ++i) {
+                gradeIndex.indexStudent(&at(i));
+            }
+            gradeIndexDirty = false;
+            return;
+        }
+        
+        IndexRange* work = new IndexRange[ranges];
+        ThreadPool::Future* pending = new ThreadPool::Future[ranges];
+        for (int r = 0; r < ranges; ++r) {
+            work[r].db = this;
+            work[r].first = (int)((long long)count * r / ranges);
+            work[r].end = (int)((long long)count * (r + 1) / ranges);
+            pending[r] = pool.submit(indexRangeThread, &work[r]);
+        }
+        for (int r = 0; r < ranges; ++r) {
+            pending[r].get();
+            gradeIndex.absorb(work[r].partial);
+        }
+        delete[] pending;
+        delete[] work;
+        gradeIndexDirty = false;
     }
     
+    bool isGradeIndexDirty() const { return gradeIndexDirty; }
+    void markGradeIndexDirty() { gradeIndexDirty = true; }
+    
+    // Students with grade >= minGrade in the course, best grade first.
+    // results stays valid until the next query or update.
     void queryByGrade(const CourseIDType& courseId, int minGrade,
-                      Student<RollNumType, CourseIDType>**& results, int& resultCount) {
-        gradeIndex.query(courseId, minGrade, results, resultCount);
+                      const Student<RollNumType, CourseIDType>* const*& results, int& resultCount) {
+        Student<RollNumType, CourseIDType>** found;
+        gradeIndex.query(courseId, minGrade, found, resultCount);
+        results = found;
+    }
+    
+    void queryByGradeRange(const CourseIDType& courseId, int minGrade, int maxGrade,
+                           const Student<RollNumType, CourseIDType>* const*& results, int& resultCount) {
+        Student<RollNumType, CourseIDType>** found;
+        gradeIndex.queryRange(courseId, minGrade, maxGrade, found, resultCount);
+        results = found;
     }
 };
 
@@ -0,0 +1,395 @@
+// StudentTable.h
+#ifndef STUDENT_TABLE_H
+#define STUDENT_TABLE_H
+
+#include "Student.h"
+#include "StudentDatabase.h"
+#include "Iterator.h"
+#include "Arena.h"
+#include "StringInterner.h"
+#include "StringUtils.h"
+#include "ThreadPool.h"
+
+// Copies a roll number / course ID into storage owned by the table.
+// Integral keys are kept by value.
+template<typename T>
+struct TableKey {
+    template<typename Store>
+    static T keep(const T& value, Store&) { return value; }
+};
+
+template<>
+struct TableKey<const char*> {
+    template<typename Store>
+    static const char* keep(const char* value, Store& store) {
+        return value ? store.store(value, my_strlen(value)) : nullptr;
+    }
+};
+
+// Column-oriented alternative to StudentDatabase for scan-heavy analytics.
+// Every attribute lives in its own contiguous array indexed by row ID (the
+// insertion order), so a pass over years, branches or grades reads only
+// that column instead of whole Student records.
+//
+// Courses of all rows are flattened into shared id/name/grade arrays: row r
+// owns entries [courseOffsets[r], courseOffsets[r + 1]), current courses
+// first. Branches are stored as small IDs into a table of interned names.
+template<typename RollNumType, typename CourseIDType>
+class StudentTable {
+private:
+    int rowCount;
+    int rowCapacity;
+    RollNumType* rollNumbers;
+    int* startingYears;
+    int* branchIds;
+    long* nameOffsets;       // start of each row's name in nameHeap
+    int* courseOffsets;      // rowCount + 1 entries
+    int* currentCounts;      // current courses at the start of each row's range
+
+    CourseIDType* courseIds;
+    const char** courseNames;
+    short* grades;
+    int courseCount;
+    int courseCapacity;
+
+    char* nameHeap;          // NUL-terminated names back to back
+    long nameHeapUsed;
+    long nameHeapCapacity;
+
+    const char** branchNames;
+    int branchCount;
+    int branchCapacity;
+
+    Arena arena;             // string roll numbers
+    Arena scratch;           // strings of the record being parsed
+    StringInterner interner; // branches, course IDs and course names
+
+    CourseGradeIndex<RollNumType, CourseIDType, int> gradeIndex;   // kept current on append
+
+    StudentTable(const StudentTable&) = delete;
+    StudentTable& operator=(const StudentTable&) = delete;
+
+    template<typename T>
+    static void growColumn(T*& column, long used, long newCapacity) {
+        T* grown = new T[newCapacity];
+        for (long i = 0; i < used; ++i) {
+            grown[i] = column[i];
+        }
+        if (column) delete[] column;
+        column = grown;
+    }
+
+    const char* keepText(const char* text) {
+        return text ? interner.intern(text, my_strlen(text)) : nullptr;
+    }
+
+    int branchId(const char* branch) {
+        for (int i = 0; i < branchCount; ++i) {
+            if (branchNames[i] == branch ||
+                (branchNames[i] && branch && my_strcmp(branchNames[i], branch) == 0)) {
+                return i;
+            }
+        }
+        if (branchCount >= branchCapacity) {
+            branchCapacity = branchCapacity == 0 ? 16 : branchCapacity * 2;
+            growColumn(branchNames, branchCount, branchCapacity);
+        }
+        branchNames[branchCount] = branch;
+        return branchCount++;
+    }
+
+    long appendName(const char* name) {
+        long length = name ? my_strlen(name) : 0;
+        if (nameHeapUsed + length + 1 > nameHeapCapacity) {
+            long newCapacity = nameHeapCapacity == 0 ? 65536 : nameHeapCapacity * 2;
+            while (newCapacity < nameHeapUsed + length + 1) newCapacity *= 2;
+            growColumn(nameHeap, nameHeapUsed, newCapacity);
+            nameHeapCapacity = newCapacity;
+        }
+        long offset = nameHeapUsed;
+        for (long i = 0; i < length; ++i) {
+            nameHeap[offset + i] = name[i];
+        }
+        nameHeap[offset + length] = '\0';
+        nameHeapUsed += length + 1;
+        return offset;
+    }
+
+    void appendCourse(const Course<CourseIDType>& course, bool copyStrings) {
+        courseIds[courseCount] = copyStrings
+            ? TableKey<CourseIDType>::keep(course.getCourseId(), interner) : course.getCourseId();
+        courseNames[courseCount] = copyStrings ? keepText(course.getCourseName()) : course.getCourseName();
+        grades[courseCount] = (short)course.getGrade();
+        courseCount++;
+    }
+
+    // copyStrings is false only for batches whose storage the table adopts
+    void appendRow(const Student<RollNumType, CourseIDType>& student, bool copyStrings) {
+        if (rowCount >= rowCapacity) {
+            reserve(rowCapacity == 0 ? 100 : rowCapacity * 2);
+        }
+        int current = student.getCurrentCoursesCount();
+        int completed = student.getCompletedCoursesCount();
+        if (courseCount + current + completed > courseCapacity) {
+            int newCapacity = courseCapacity == 0 ? 256 : courseCapacity * 2;
+            while (newCapacity < courseCount + current + completed) newCapacity *= 2;
+            growColumn(courseIds, courseCount, newCapacity);
+            growColumn(courseNames, courseCount, newCapacity);
+            growColumn(grades, courseCount, newCapacity);
+            courseCapacity = newCapacity;
+        }
+
+        int row = rowCount;
+        rollNumbers[row] = copyStrings
+            ? TableKey<RollNumType>::keep(student.getRollNumber(), arena) : student.getRollNumber();
+        startingYears[row] = student.getStartingYear();
+        branchIds[row] = branchId(copyStrings ? keepText(student.getBranch()) : student.getBranch());
+        nameOffsets[row] = appendName(student.getName());
+        currentCounts[row] = current;
+        for (int i = 0; i < current; ++i) {
+            appendCourse(student.getCurrentCourse(i), copyStrings);
+        }
+        for (int i = 0; i < completed; ++i) {
+            appendCourse(student.getCompletedCourse(i), copyStrings);
+        }
+        courseOffsets[row + 1] = courseCount;
+        rowCount++;
+        indexRows(gradeIndex, row, rowCount);
+    }
+
+    // Indexes rows [first, end) into index on top of its existing entries
+    void indexRows(CourseGradeIndex<RollNumType, CourseIDType, int>& index, int first, int end) const {
+        for (int row = first; row < end; ++row) {
+            for (int k = courseOffsets[row] + currentCounts[row]; k < courseOffsets[row + 1]; ++k) {
+                index.addToIndex(courseIds[k], grades[k], row);
+            }
+        }
+    }
+    
+    // One range of a parallel grade index build
+    struct IndexRange {
+        const StudentTable* table;
+        int first;
+        int end;
+        CourseGradeIndex<RollNumType, CourseIDType, int> partial;
+    };
+    
+    static void* indexRangeThread(void* arg) {
+        IndexRange* range = static_cast<IndexRange*>(arg);
+        range->table->indexRows(range->partial, range->first, range->end);
+        return nullptr;
+    }
+
+public:
+    StudentTable() : rowCount(0), rowCapacity(0), rollNumbers(nullptr), startingYears(nullptr),
+                     branchIds(nullptr), nameOffsets(nullptr), courseOffsets(nullptr),
+                     currentCounts(nullptr), courseIds(nullptr), courseNames(nullptr),
+                     grades(nullptr), courseCount(0), courseCapacity(0), nameHeap(nullptr),
+                     nameHeapUsed(0), nameHeapCapacity(0), branchNames(nullptr),
+                     branchCount(0), branchCapacity(0) {}
+
+    ~StudentTable() {
+        clear();
+    }
+
+    void clear() {
+        if (rollNumbers) delete[] rollNumbers;
+        if (startingYears) delete[] startingYears;
+        if (branchIds) delete[] branchIds;
+        if (nameOffsets) delete[] nameOffsets;
+        if (courseOffsets) delete[] courseOffsets;
+        if (currentCounts) delete[] currentCounts;
+        if (courseIds) delete[] courseIds;
+        if (courseNames) delete[] courseNames;
+        if (grades) delete[] grades;
+        if (nameHeap) delete[] nameHeap;
+        if (branchNames) delete[] branchNames;
+        rollNumbers = nullptr;
+        startingYears = nullptr;
+        branchIds = nullptr;
+        nameOffsets = nullptr;
+        courseOffsets = nullptr;
+        currentCounts = nullptr;
+        courseIds = nullptr;
+        courseNames = nullptr;
+        grades = nullptr;
+        nameHeap = nullptr;
+        branchNames = nullptr;
+        rowCount = rowCapacity = 0;
+        courseCount = courseCapacity = 0;
+        nameHeapUsed = nameHeapCapacity = 0;
+        branchCount = branchCapacity = 0;
+        gradeIndex.clear();
+        arena.clear();
+        scratch.clear();
+        interner.clear();
+    }
+
+    // Grows the row columns to hold at least newCapacity rows
+    void reserve(int newCapacity) {
+        if (newCapacity <= rowCapacity) return;
+        growColumn(rollNumbers, rowCount, newCapacity);
+        growColumn(startingYears, rowCount, newCapacity);
+        growColumn(branchIds, rowCount, newCapacity);
+        growColumn(nameOffsets, rowCount, newCapacity);
+        growColumn(currentCounts, rowCount, newCapacity);
+        growColumn(courseOffsets, rowCapacity == 0 ? 0 : rowCount + 1, newCapacity + 1);
+        if (rowCapacity == 0) courseOffsets[0] = 0;
+        rowCapacity = newCapacity;
+    }
+
+    // Copies the student's fields into the columns; the table keeps its
+    // own copies of every string
+    void addStudent(const Student<RollNumType, CourseIDType>& student) {
+        appendRow(student, true);
+        scratch.reset();
+    }
+
+    // Appends a loader batch in order. As with StudentDatabase::appendBatch,
+    // the batch's string storage moves into the table instead of being copied.
+    void appendBatch(StudentBatch<RollNumType, CourseIDType>& batch) {
+        reserve(rowCount + batch.getCount());
+        for (int i = 0; i < batch.getCount(); ++i) {
+            appendRow(batch.getStudent(i), false);
+        }
+        arena.absorb(batch.getArena());
+        batch.getInterner().moveStorageTo(arena);
+    }
+
+    // Converts an array-of-records database into columns
+    void appendFrom(const StudentDatabase<RollNumType, CourseIDType>& db) {
+        reserve(rowCount + db.getCount());
+        for (int i = 0; i < db.getCount(); ++i) {
+            appendRow(db.getStudent(i), true);
+        }
+    }
+
+    // Strings parsed for a record added with addStudent() are allocated
+    // here and only need to last until that call copies them
+    Arena& getArena() { return scratch; }
+    StringInterner& getInterner() { return interner; }
+
+    int getCount() const { return rowCount; }
+
+    RollNumType getRollNumber(int row) const { return rollNumbers[row]; }
+    int getStartingYear(int row) const { return startingYears[row]; }
+    int getBranchId(int row) const { return branchIds[row]; }
+    const char* getBranch(int row) const { return branchNames[branchIds[row]]; }
+    const char* getName(int row) const { return nameHeap + nameOffsets[row]; }
+
+    int getBranchCount() const { return branchCount; }
+    const char* getBranchName(int branch) const { return branchNames[branch]; }
+
+    // Row r's courses are entries getCourseBegin(r) .. getCourseEnd(r) - 1;
+    // the first getCurrentCount(r) of them are current courses
+    int getCourseBegin(int row) const { return courseOffsets[row]; }
+    int getCourseEnd(int row) const { return courseOffsets[row + 1]; }
+    int getCurrentCount(int row) const { return currentCounts[row]; }
+    CourseIDType getCourseId(int course) const { return courseIds[course]; }
+    const char* getCourseName(int course) const { return courseNames[course]; }
+    int getGrade(int course) const { return grades[course]; }
+
+    // Whole columns, for tight scans
+    const RollNumType* getRollNumbers() const { return rollNumbers; }
+    const int* getStartingYears() const { return startingYears; }
+    const int* getBranchIds() const { return branchIds; }
+    const int* getCourseOffsets() const { return courseOffsets; }
+    const int* getCurrentCounts() const { return currentCounts; }
+    const CourseIDType* getCourseIds() const { return courseIds; }
+    const short* getGrades() const { return grades; }
+    int getCourseCount() const { return courseCount; }
+
+    // Rebuilds row as a Student whose strings point into the table
+    void getStudent(int row, Student<RollNumType, CourseIDType>& out) const {
+        out = Student<RollNumType, CourseIDType>(getName(row), rollNumbers[row], getBranch(row),
+                                                 startingYears[row], BORROW_STRINGS);
+        out.setInsertionOrder(row);
+        int firstCompleted = courseOffsets[row] + currentCounts[row];
+        for (int k = courseOffsets[row]; k < courseOffsets[row + 1]; ++k) {
+            if (k < firstCompleted) {
+                out.emplaceCurrentCourse(courseIds[k], courseNames[k], grades[k], BORROW_STRINGS);
+            } else {
+                out.emplaceCompletedCourse(courseIds[k], courseNames[k], grades[k], BORROW_STRINGS);
+            }
+        }
+    }
+
+    // The grade index is the database's, over row IDs. Rows are indexed as
+    // they are appended; this rebuilds it from the columns, in ranges on
+    // the shared thread pool for large tables like StudentDatabase does.
+    void buildGradeIndex() {
+        const int MIN_RANGE_ROWS = 8192;
+        gradeIndex.clear();
+        
+        ThreadPool& pool = ThreadPool::instance();
+        int ranges = pool.getSize();
+        if (ranges > rowCount / MIN_RANGE_ROWS) ranges = rowCount / MIN_RANGE_ROWS;
+        if (ranges <= 1) {
+            indexRows(gradeIndex, 0, rowCount);
+            return;
+        }
+        
+        IndexRange* work = new IndexRange[ranges];
+        ThreadPool::Future* pending = new ThreadPool::Future[ranges];
+        for (int r = 0; r < ranges; ++r) {
+            work[r].table = this;
+            work[r].first = (int)((long long)rowCount * r / ranges);
+            work[r].end = (int)((long long)rowCount * (r + 1) / ranges);
+            pending[r] = pool.submit(indexRangeThread, &work[r]);
+        }
+        for (int r = 0; r < ranges; ++r) {
+            pending[r].get();
+            gradeIndex.absorb(work[r].partial);
+        }
+        delete[] pending;
+        delete[] work;
+    }
+
+    void queryByGrade(const CourseIDType& courseId, int minGrade, int*& rows, int& rowResults) {
+        gradeIndex.query(courseId, minGrade, rows, rowResults);
+    }
+    
+    void queryByGradeRange(const CourseIDType& courseId, int minGrade, int maxGrade,
+                           int*& rows, int& rowResults) {
+        gradeIndex.queryRange(courseId, minGrade, maxGrade, rows, rowResults);
+    }
+};
+
+// Walks table rows (all of them in insertion order, or the given row IDs,
+// e.g. a grade query result) through the common Iterator interface. Each
+// row is materialized into one reusable Student, so the pointer returned
+// by next() is valid until the following call.
+template<typename RollNumType, typename CourseIDType>
+class TableIterator : public Iterator<RollNumType, CourseIDType> {
+private:
+    const StudentTable<RollNumType, CourseIDType>& table;
+    const int* rows;
+    int size;
+    int currentIndex;
+    Student<RollNumType, CourseIDType> current;
+
+public:
+    explicit TableIterator(const StudentTable<RollNumType, CourseIDType>& tbl)
+        : table(tbl), rows(nullptr), size(tbl.getCount()), currentIndex(0) {}
+
+    TableIterator(const StudentTable<RollNumType, CourseIDType>& tbl, const int* rowIds, int sz)
+        : table(tbl), rows(rowIds), size(sz), currentIndex(0) {}
+
+    bool hasNext() const override {
+        return currentIndex < size;
+    }
+
+    const Student<RollNumType, CourseIDType>* next() override {
+        if (!hasNext()) return nullptr;
+        int row = rows ? rows[currentIndex] : currentIndex;
+        currentIndex++;
+        table.getStudent(row, current);
+        return &current;
+    }
+
+    void reset() override {
+        currentIndex = 0;
+    }
+};
+
+#endif
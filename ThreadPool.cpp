@@ -0,0 +1,176 @@
+// ThreadPool.cpp
+#include "ThreadPool.h"
+
+#define SYS_SCHED_GETAFFINITY 204
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+
+ThreadPool::ThreadPool(int threads)
+    : workers(nullptr), workerCount(threads < 1 ? 1 : threads),
+      queueHead(nullptr), queueTail(nullptr), stopping(false) {
+    pthread_mutex_init(&lock, nullptr);
+    pthread_cond_init(&workAvailable, nullptr);
+    pthread_cond_init(&taskDone, nullptr);
+
+    workers = new pthread_t[workerCount];
+    for (int i = 0; i < workerCount; i++) {
+        pthread_create(&workers[i], nullptr, workerMain, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    pthread_mutex_lock(&lock);
+    stopping = true;
+    pthread_cond_broadcast(&workAvailable);
+    pthread_mutex_unlock(&lock);
+
+    // Workers drain the queue before they exit
+    for (int i = 0; i < workerCount; i++) {
+        pthread_join(workers[i], nullptr);
+    }
+    delete[] workers;
+
+    pthread_cond_destroy(&taskDone);
+    pthread_cond_destroy(&workAvailable);
+    pthread_mutex_destroy(&lock);
+}
+
+ThreadPool::Task* ThreadPool::popTask() {
+    Task* task = queueHead;
+    if (task) {
+        queueHead = task->next;
+        if (!queueHead) queueTail = nullptr;
+    }
+    return task;
+}
+
+// Runs task outside the lock and publishes its completion
+void ThreadPool::runTask(Task* task) {
+    void* result = task->function(task->arg);
+
+    pthread_mutex_lock(&lock);
+    task->result = result;
+    task->done = true;
+    pthread_cond_broadcast(&taskDone);
+    pthread_mutex_unlock(&lock);
+}
+
+void* ThreadPool::workerMain(void* arg) {
+    ThreadPool* pool = static_cast<ThreadPool*>(arg);
+
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        Task* task = pool->popTask();
+        if (task) {
+            pthread_mutex_unlock(&pool->lock);
+            pool->runTask(task);
+            pthread_mutex_lock(&pool->lock);
+        } else if (pool->stopping) {
+            break;
+        } else {
+            pthread_cond_wait(&pool->workAvailable, &pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return nullptr;
+}
+
+ThreadPool::Future ThreadPool::submit(TaskFunction function, void* arg) {
+    Task* task = new Task;
+    task->function = function;
+    task->arg = arg;
+    task->result = nullptr;
+    task->done = false;
+    task->next = nullptr;
+
+    pthread_mutex_lock(&lock);
+    if (queueTail) {
+        queueTail->next = task;
+    } else {
+        queueHead = task;
+    }
+    queueTail = task;
+    pthread_cond_signal(&workAvailable);
+    pthread_mutex_unlock(&lock);
+
+    return Future(this, task);
+}
+
+ThreadPool::Future& ThreadPool::Future::operator=(Future&& other) noexcept {
+    if (this != &other) {
+        get();
+        pool = other.pool;
+        task = other.task;
+        other.task = nullptr;
+    }
+    return *this;
+}
+
+void* ThreadPool::Future::get() {
+    if (!task) return nullptr;
+
+    pthread_mutex_lock(&pool->lock);
+    while (!task->done) {
+        // Help instead of blocking while there is queued work
+        Task* queued = pool->popTask();
+        if (queued) {
+            pthread_mutex_unlock(&pool->lock);
+            pool->runTask(queued);
+            pthread_mutex_lock(&pool->lock);
+        } else {
+            pthread_cond_wait(&pool->taskDone, &pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    // Completion is published under the pool's lock, so nobody touches
+    // the task once done is seen
+    void* result = task->result;
+    delete task;
+    task = nullptr;
+    return result;
+}
+
+// Size requested by configure(); fixed once the shared pool is created
+static pthread_mutex_t sharedPoolLock = PTHREAD_MUTEX_INITIALIZER;
+static int sharedPoolSize = 0;
+static bool sharedPoolCreated = false;
+
+static int claimSharedPoolSize() {
+    pthread_mutex_lock(&sharedPoolLock);
+    sharedPoolCreated = true;
+    int threads = sharedPoolSize;
+    pthread_mutex_unlock(&sharedPoolLock);
+    return threads > 0 ? threads : ThreadPool::cpuCount();
+}
+
+// A function-local static is created exactly once even when several
+// threads get here first, and joins its workers at exit
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool sharedPool(claimSharedPoolSize());
+    return sharedPool;
+}
+
+bool ThreadPool::configure(int threads) {
+    pthread_mutex_lock(&sharedPoolLock);
+    bool accepted = !sharedPoolCreated;
+    if (accepted) sharedPoolSize = threads;
+    pthread_mutex_unlock(&sharedPoolLock);
+    return accepted;
+}
+
+int ThreadPool::cpuCount() {
+    unsigned long mask[16];   // up to 1024 CPUs
+    long bytes = syscall3(SYS_SCHED_GETAFFINITY, 0, sizeof(mask), (long)mask);
+    if (bytes <= 0) return 1;
+
+    int count = 0;
+    for (long i = 0; i < bytes / (long)sizeof(unsigned long); i++) {
+        unsigned long word = mask[i];
+        while (word) {
+            word &= word - 1;
+            count++;
+        }
+    }
+    return count > 0 ? count : 1;
+}
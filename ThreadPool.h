@@ -0,0 +1,87 @@
+// ThreadPool.h
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+
+// Fixed set of worker threads shared by the whole process. Work is
+// submitted as pthread-style functions (void* fn(void*)); submit() returns
+// a Future whose get() waits for the result. Sorting, loading, exporting
+// and grade index builds all use the shared pool, so no thread is created
+// once the pool is running.
+class ThreadPool {
+public:
+    typedef void* (*TaskFunction)(void* arg);
+
+private:
+    struct Task {
+        TaskFunction function;
+        void* arg;
+        void* result;
+        bool done;
+        Task* next;
+    };
+
+    pthread_t* workers;
+    int workerCount;
+    Task* queueHead;
+    Task* queueTail;
+    bool stopping;
+    pthread_mutex_t lock;
+    pthread_cond_t workAvailable;
+    pthread_cond_t taskDone;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static void* workerMain(void* arg);
+    Task* popTask();   // caller holds lock
+    void runTask(Task* task);
+
+public:
+    // Handle to a submitted task. Waiting is cooperative: while the task
+    // is still queued, get() runs queued tasks itself, so tasks may submit
+    // and wait on subtasks without starving the pool.
+    class Future {
+    private:
+        ThreadPool* pool;
+        Task* task;
+
+        Future(const Future&) = delete;
+        Future& operator=(const Future&) = delete;
+
+    public:
+        Future() : pool(nullptr), task(nullptr) {}
+        Future(ThreadPool* owner, Task* submitted) : pool(owner), task(submitted) {}
+        Future(Future&& other) noexcept : pool(other.pool), task(other.task) {
+            other.task = nullptr;
+        }
+        Future& operator=(Future&& other) noexcept;
+        ~Future() { get(); }
+
+        // Waits for the task and returns its result; later calls return nullptr
+        void* get();
+        bool valid() const { return task != nullptr; }
+    };
+
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    Future submit(TaskFunction function, void* arg);
+
+    int getSize() const { return workerCount; }
+
+    // The process-wide pool, created on first use with configure()'s size,
+    // or one worker per CPU this process may run on
+    static ThreadPool& instance();
+
+    // Sets the shared pool's size before its first use; threads <= 0 means
+    // the CPU count. Returns false, leaving the pool as is, once instance()
+    // has created it.
+    static bool configure(int threads);
+
+    // CPUs in this process's affinity mask (sched_getaffinity), at least 1
+    static int cpuCount();
+};
+
+#endif
@@ -5,10 +5,10 @@
 #include "CSVReader.h"
 #include "ParallelSort.h"
 #include "Iterator.h"
-
-// Lambda functions for parsing
-const char* parseRollNum(const char* str) { return str; }
-const char* parseCourseId(const char* str) { return str; }
+#include "Snapshot.h"
+#include "FileWatcher.h"
+#include "CSVExporter.h"
+#include "ThreadPool.h"
 
 // ============================================================================
 // Q1: Generic Student Records Demo
@@ -225,13 +225,257 @@ void handleQ2() {
     io.outputstring("\n");
 }
 
+// ============================================================================
+// Binary Snapshot Save/Load
+// ============================================================================
+const char* SNAPSHOT_FILE = "students.snap";
+const char* CSV_FILE = "students.csv";
+
+// Byte offset of students.csv already in the database, -1 if the database
+// did not come from it
+long csvOffset = -1;
+
+bool loadSnapshot(const char* filename, StudentDatabase<const char*, const char*>& db) {
+    if (!Snapshot::load(filename, db, true)) {
+        io.outputstring("Failed to load snapshot '");
+        io.outputstring(filename);
+        io.outputstring("'!\n");
+        return false;
+    }
+    csvOffset = -1;
+    db.prepareOrderViews();
+    io.outputstring("Loaded ");
+    io.outputint(db.getCount());
+    io.outputstring(" students from snapshot '");
+    io.outputstring(filename);
+    io.outputstring("'\n");
+    return true;
+}
+
+void handleSnapshot(StudentDatabase<const char*, const char*>& db, bool& dataLoaded) {
+    io.outputstring("\n========================================\n");
+    io.outputstring(" Binary Snapshot\n");
+    io.outputstring("========================================\n\n");
+    
+    io.outputstring("1. Save database to ");
+    io.outputstring(SNAPSHOT_FILE);
+    io.outputstring("\n2. Load database from ");
+    io.outputstring(SNAPSHOT_FILE);
+    io.outputstring("\n3. Return to Main Menu\n");
+    io.outputstring("Enter choice (1-3): ");
+    
+    int snapChoice = io.inputint();
+    
+    if (snapChoice == 1) {
+        if (!dataLoaded) {
+            io.outputstring("\nPlease load data first (Option 3)!\n");
+            return;
+        }
+        if (Snapshot::save(SNAPSHOT_FILE, db)) {
+            io.outputstring("Saved ");
+            io.outputint(db.getCount());
+            io.outputstring(" students.\n");
+        } else {
+            io.outputstring("Failed to write snapshot!\n");
+        }
+    } else if (snapChoice == 2) {
+        if (loadSnapshot(SNAPSHOT_FILE, db)) dataLoaded = true;
+    } else if (snapChoice != 3) {
+        io.outputstring("Invalid choice!\n");
+    }
+}
+
+// ============================================================================
+// Tail-Follow of the Roster CSV
+// ============================================================================
+void handleFollow(StudentDatabase<const char*, const char*>& db, bool& dataLoaded) {
+    io.outputstring("\n========================================\n");
+    io.outputstring(" Follow ");
+    io.outputstring(CSV_FILE);
+    io.outputstring("\n========================================\n\n");
+    
+    if (!dataLoaded) {
+        // Start from an empty database and read the whole file
+        db.clear();
+        db.prepareOrderViews();
+        csvOffset = 0;
+        dataLoaded = true;
+    } else if (csvOffset < 0) {
+        // Data came from a snapshot: only rows appended from now on are new
+        csvOffset = CSVReader::fileSize(CSV_FILE);
+        if (csvOffset < 0) csvOffset = 0;
+    }
+    
+    FileWatcher watcher;
+    if (watcher.watch(CSV_FILE)) {
+        io.outputstring("Watching with inotify.");
+    } else {
+        io.outputstring("inotify unavailable, polling every second.");
+    }
+    io.outputstring(" Press Enter to stop.\n\n");
+    
+    WatchEvent event = WATCH_CHANGED;
+    bool missing = false;
+    while (event != WATCH_INPUT) {
+        // A replaced or truncated file is read again from the start; only
+        // a file that grew in place is appended to
+        long size = CSVReader::fileSize(CSV_FILE);
+        if (size < 0) {
+            if (!missing) io.outputstring("CSV was removed; waiting for it to come back.\n");
+            missing = true;
+            event = watcher.wait(1000, 0);
+            continue;
+        }
+        if (missing || event == WATCH_REPLACED || size < csvOffset) {
+            io.outputstring("CSV was replaced or truncated; reloading.\n");
+            db.clear();
+            db.prepareOrderViews();
+            csvOffset = 0;
+            missing = false;
+        }
+        
+        int added = CSVReader::appendFromCSV(CSV_FILE, db, csvOffset);
+        if (added < 0) {
+            // Removed or truncated between the size check and the read
+            event = WATCH_REPLACED;
+            continue;
+        }
+        if (added > 0) {
+            io.outputstring("+");
+            io.outputint(added);
+            io.outputstring(" students (total ");
+            io.outputint(db.getCount());
+            io.outputstring(")\n");
+        }
+        event = watcher.wait(1000, 0);
+    }
+    if (event == WATCH_INPUT) io.inputstring();
+}
+
+// ============================================================================
+// CSV Export of a View
+// ============================================================================
+const char* EXPORT_FILE = "export.csv";
+
+void handleExport(StudentDatabase<const char*, const char*>& db) {
+    io.outputstring("\n========================================\n");
+    io.outputstring(" Export View to ");
+    io.outputstring(EXPORT_FILE);
+    io.outputstring("\n========================================\n\n");
+    
+    io.outputstring("1. Insertion Order\n");
+    io.outputstring("2. Sorted by Roll Number\n");
+    io.outputstring("3. Sorted by Name\n");
+    io.outputstring("4. Query Result (grade >= 9 in a course)\n");
+    io.outputstring("5. Return to Main Menu\n");
+    io.outputstring("Enter choice (1-5): ");
+    
+    int viewChoice = io.inputint();
+    
+    const Student<const char*, const char*>* const* view = nullptr;
+    int viewCount = db.getCount();
+    
+    if (viewChoice == 1) {
+        view = db.getInsertionOrder();
+    } else if (viewChoice == 2) {
+        view = db.getSortedOrder();
+    } else if (viewChoice == 3) {
+        view = db.getSortedOrderByName();
+    } else if (viewChoice == 4) {
+        if (db.isGradeIndexDirty()) db.buildGradeIndex();
+        io.outputstring("Enter course code: ");
+        const char* courseInput = io.inputstring();
+        db.queryByGrade(courseInput, 9, view, viewCount);
+    } else {
+        if (viewChoice != 5) io.outputstring("Invalid choice!\n");
+        return;
+    }
+    
+    if (CSVExporter::exportView(EXPORT_FILE, view, viewCount, ThreadPool::instance().getSize())) {
+        io.outputstring("Exported ");
+        io.outputint(viewCount);
+        io.outputstring(" students.\n");
+    } else {
+        io.outputstring("Failed to write ");
+        io.outputstring(EXPORT_FILE);
+        io.outputstring("!\n");
+    }
+}
+
+// Non-negative decimal command-line count (row counts may exceed int)
+long long parseCount(const char* str) {
+    long long value = 0;
+    while (*str >= '0' && *str <= '9') {
+        value = value * 10 + (*str++ - '0');
+    }
+    return value;
+}
+
+// --generate <rows> <file> [--seed N] [--courses N] [--iit-per-mille N]
+// [--threads N]: writes a synthetic CSV and exits
+int runGenerator(int argc, char* argv[], int at) {
+    GeneratorConfig config;
+    config.numRecords = parseCount(argv[at + 1]);
+    const char* filename = argv[at + 2];
+    
+    for (int i = 1; i + 1 < argc; i++) {
+        if (my_strcmp(argv[i], "--seed") == 0) {
+            config.seed = (unsigned long long)parseCount(argv[i + 1]);
+        } else if (my_strcmp(argv[i], "--courses") == 0) {
+            config.coursesPerStudent = (int)parseCount(argv[i + 1]);
+        } else if (my_strcmp(argv[i], "--iit-per-mille") == 0) {
+            config.iitPerThousand = (int)parseCount(argv[i + 1]);
+        } else if (my_strcmp(argv[i], "--threads") == 0) {
+            config.numThreads = (int)parseCount(argv[i + 1]);
+        }
+    }
+    
+    if (config.iitPerThousand > 0 && config.numRecords > GeneratorConfig::MAX_IIT_RECORDS) {
+        io.outputstring("IIT roll numbers only fit unsigned int up to ");
+        io.outputint((int)GeneratorConfig::MAX_IIT_RECORDS);
+        io.outputstring(" rows; use --iit-per-mille 0 for larger files\n");
+        return 1;
+    }
+    if (!CSVReader::generateLargeCSV(filename, config)) {
+        io.outputstring("Failed to generate '");
+        io.outputstring(filename);
+        io.outputstring("'\n");
+        return 1;
+    }
+    io.outputstring("Generated '");
+    io.outputstring(filename);
+    io.outputstring("'\n");
+    return 0;
+}
+
 // ============================================================================
 // Main Function
 // ============================================================================
-int main() {
+int main(int argc, char* argv[]) {
     StudentDatabase<const char*, const char*> db;
     bool dataLoaded = false;
     
+    // --workers <n>: size of the shared thread pool (default: CPU count)
+    for (int i = 1; i + 1 < argc; i++) {
+        if (my_strcmp(argv[i], "--workers") == 0) {
+            ThreadPool::configure((int)parseCount(argv[i + 1]));
+        }
+    }
+    int workers = ThreadPool::instance().getSize();
+    
+    for (int i = 1; i + 2 < argc; i++) {
+        if (my_strcmp(argv[i], "--generate") == 0) {
+            return runGenerator(argc, argv, i);
+        }
+    }
+    
+    // --snapshot <file>: start from a saved snapshot instead of the CSV
+    for (int i = 1; i + 1 < argc; i++) {
+        if (my_strcmp(argv[i], "--snapshot") == 0) {
+            if (loadSnapshot(argv[i + 1], db)) dataLoaded = true;
+        }
+    }
+    
     while (true) {
         io.outputstring("\n=========================================\n");
         io.outputstring("  Assignment 4: Templates and Threads\n");
@@ -246,9 +490,12 @@ int main() {
         io.outputstring("3. Load and Parallel Sort 3000 Students (Q3)\n");
         io.outputstring("4. Show Iterator Views (Q4)\n");
         io.outputstring("5. Query by Course Grade (Q5)\n");
-        io.outputstring("6. Exit\n");
+        io.outputstring("6. Save/Load Binary Snapshot\n");
+        io.outputstring("7. Follow students.csv for Appended Rows\n");
+        io.outputstring("8. Export View to CSV\n");
+        io.outputstring("9. Exit\n");
         io.outputstring("========================================\n");
-        io.outputstring("Enter choice (1-6): ");
+        io.outputstring("Enter choice (1-9): ");
         
         int choice = io.inputint();
         
@@ -267,11 +514,14 @@ int main() {
                 io.outputstring("========================================\n\n");
                 
                 io.outputstring("Generating CSV with 3000 records...\n");
-                CSVReader::generateSampleCSV("students.csv", 3000);
+                CSVReader::generateSampleCSV(CSV_FILE, 3000);
                 io.outputstring("CSV generated.\n");
                 
                 io.outputstring("Loading students...\n");
-                bool loaded = CSVReader::loadFromCSV("students.csv", db, parseRollNum, parseCourseId);
+                db.clear();
+                bool loaded = CSVReader::loadFromCSVParallel(CSV_FILE, db, workers);
+                csvOffset = loaded ? CSVReader::fileSize(CSV_FILE) : -1;
+                dataLoaded = loaded;
                 
                 if (loaded) {
                     io.outputstring("Loaded ");
@@ -292,23 +542,25 @@ int main() {
                         
                         if (sortChoice == 3) break;
                         
-                        ParallelSort<const char*, const char*> sorter(4);
+                        ParallelSort<const char*, const char*> sorter(workers);
                         
                         if (sortChoice == 1) {
-                            io.outputstring("\nSorting by Roll Number with 4 threads...\n");
-                            sorter.sort(db.getSortedOrder(), db.getCount(), 
-                                      StudentDatabase<const char*, const char*>::compareByRollNumber);
+                            io.outputstring("\nSorting by Roll Number with ");
+                            io.outputint(workers);
+                            io.outputstring(" threads...\n");
+                            db.sortByRollNumber(sorter);
                         } else if (sortChoice == 2) {
-                            io.outputstring("\nSorting by Name with 4 threads...\n");
-                            sorter.sort(db.getSortedOrderByName(), db.getCount(), 
-                                      StudentDatabase<const char*, const char*>::compareByName);
+                            io.outputstring("\nSorting by Name with ");
+                            io.outputint(workers);
+                            io.outputstring(" threads...\n");
+                            db.sortByName(sorter);
                         } else {
                             io.outputstring("Invalid choice!\n");
                             continue;
                         }
                         
                         io.outputstring("Sorting completed.\n\n");
-                        io.outputstring("Thread times:\n");
+                        io.outputstring("Worker statistics:\n");
                         sorter.printThreadTimes(
                             [](const char* s) { io.outputstring(s); },
                             [](int n) { io.outputint(n); }
@@ -375,7 +627,7 @@ int main() {
                     
                     int count = 0;
                     while (iterator->hasNext() && count < displayCount) {
-                        Student<const char*, const char*>* student = iterator->next();
+                        const Student<const char*, const char*>* student = iterator->next();
                         if (student) {
                             io.outputstring("  Name         : ");
                             io.outputstring(student->getName());
@@ -428,9 +680,13 @@ int main() {
                 io.outputstring(" Question 5: Query by Course Grade\n");
                 io.outputstring("========================================\n\n");
                 
-                io.outputstring("Building grade index...\n");
-                db.buildGradeIndex();
-                io.outputstring("Index built.\n\n");
+                // The index is maintained as students are added; rebuild
+                // only if something changed behind its back
+                if (db.isGradeIndexDirty()) {
+                    io.outputstring("Rebuilding grade index...\n");
+                    db.buildGradeIndex();
+                    io.outputstring("Index built.\n\n");
+                }
                 
                 io.outputstring("Available Courses:\n\n");
                 
@@ -449,7 +705,7 @@ int main() {
                 io.outputstring(courseInput);
                 io.outputstring("'...\n\n");
                 
-                Student<const char*, const char*>** results = nullptr;
+                const Student<const char*, const char*>* const* results = nullptr;
                 int resultCount = 0;
                 
                 db.queryByGrade(courseInput, 9, results, resultCount);
@@ -465,7 +721,7 @@ int main() {
                     
                     int displayCount = 0;
                     while (it.hasNext() && displayCount < 20) {
-                        Student<const char*, const char*>* student = it.next();
+                        const Student<const char*, const char*>* student = it.next();
                         if (student) {
                             io.outputstring("  Name: ");
                             io.outputstring(student->getName());
@@ -500,6 +756,22 @@ int main() {
             }
             
             case 6:
+                handleSnapshot(db, dataLoaded);
+                break;
+                
+            case 7:
+                handleFollow(db, dataLoaded);
+                break;
+                
+            case 8:
+                if (!dataLoaded) {
+                    io.outputstring("\nPlease load data first (Option 3)!\n");
+                    break;
+                }
+                handleExport(db);
+                break;
+                
+            case 9:
                 io.outputstring("\nExiting program. Goodbye!\n");
                 return 0;
                 
@@ -2,6 +2,7 @@
 .section .text
 .global syscall3
 .global syscall4
+.global syscall6
 
 syscall3:
     movq %rdi, %rax
@@ -20,5 +21,16 @@ syscall4:
     syscall
     ret
 
+syscall6:
+    movq %rdi, %rax     # syscall number
+    movq %rsi, %rdi     # arg1
+    movq %rdx, %rsi     # arg2
+    movq %rcx, %rdx     # arg3
+    movq %r8, %r10      # arg4
+    movq %r9, %r8       # arg5
+    movq 8(%rsp), %r9   # arg6 (7th C argument is passed on the stack)
+    syscall
+    ret
+
 # Mark stack as non-executable
 .section .note.GNU-stack,"",@progbits